@@ -0,0 +1,82 @@
+#include <ucx.h>
+
+/*
+ * earliest deadline first real time tasks. two periodic tasks are admitted
+ * (densities 0.2 and 0.34) and a third one is rejected, as it would take the
+ * real time load over 1. a best effort task keeps the cpu busy with what is
+ * left, and the number of jobs and deadline misses of each task is printed
+ * every two seconds. periods, capacities and deadlines are in ticks.
+ */
+
+volatile uint32_t ctrl_jobs, sample_jobs;
+
+void spin(uint32_t ms)
+{
+	uint64_t end = _read_us() + ms * 1000;
+
+	while (_read_us() < end);
+}
+
+void ctrl(void)
+{
+	for (;;) {
+		spin(12);
+		ctrl_jobs++;
+		ucx_task_rt_wait();
+	}
+}
+
+void sample(void)
+{
+	for (;;) {
+		spin(35);
+		sample_jobs++;
+		ucx_task_rt_wait();
+	}
+}
+
+void filter(void)
+{
+	for (;;) {
+		spin(200);
+		ucx_task_rt_wait();
+	}
+}
+
+void hog(void)
+{
+	volatile uint32_t x = 0;
+
+	for (;;)
+		x++;
+}
+
+void report(void)
+{
+	struct task_stats_s ctrl_stats, sample_stats, hog_stats;
+
+	for (;;) {
+		ucx_task_delay(200);
+		ucx_task_stats(0, &ctrl_stats);
+		ucx_task_stats(1, &sample_stats);
+		ucx_task_stats(2, &hog_stats);
+		printf("ctrl: %d jobs, %d misses  sample: %d jobs, %d misses  hog: %d ms\n",
+			ctrl_jobs, ctrl_stats.misses, sample_jobs, sample_stats.misses,
+			(uint32_t)(hog_stats.run_time / 1000));
+	}
+}
+
+int32_t app_main(void)
+{
+	int32_t err;
+
+	ucx_task_rt_add(ctrl, DEFAULT_STACK_SIZE, 10, 2, 10);
+	ucx_task_rt_add(sample, DEFAULT_STACK_SIZE, 20, 5, 15);
+	err = ucx_task_rt_add(filter, DEFAULT_STACK_SIZE, 50, 25, 50);
+	printf("filter: %s\n", err == ERR_TASK_RT_LOAD ? "rejected" : "admitted");
+	ucx_task_add(hog, DEFAULT_STACK_SIZE);
+	ucx_task_add(report, DEFAULT_STACK_SIZE);
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
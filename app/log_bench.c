@@ -0,0 +1,60 @@
+#include <ucx.h>
+
+/*
+ * cost of a deferred log record, compared to formatting the same text with
+ * sprintf(). a low priority task sends the log records to the console, to be
+ * decoded on the host with tools/logdec.py:
+ *
+ *   make debug | tools/logdec.py -e build/target/image.elf
+ */
+
+#define BATCH		32		/* records that fit in the log buffer */
+#define ROUNDS		32
+
+void bench(void)
+{
+	char buf[64];
+	uint32_t i, k, n = 0, us_log, us_fmt;
+	uint64_t t;
+
+	for (;;) {
+		us_log = us_fmt = 0;
+		for (k = 0; k < ROUNDS; k++) {
+			t = _read_us();
+			for (i = 0; i < BATCH; i++)
+				ucx_log("sample %d: value %d, status %x\n", k, i * 7, 0xbeef);
+			us_log += _read_us() - t;
+
+			t = _read_us();
+			for (i = 0; i < BATCH; i++)
+				sprintf(buf, "sample %d: value %d, status %x\n", k, i * 7, 0xbeef);
+			us_fmt += _read_us() - t;
+
+			/* let the logger task drain the buffer */
+			ucx_task_delay(2);
+		}
+
+		printf("round %d: %d records, log %d us, sprintf %d us\n",
+			n, BATCH * ROUNDS, us_log, us_fmt);
+		ucx_log("round %d done\n", n++);
+		ucx_task_delay(100);
+	}
+}
+
+void logger(void)
+{
+	for (;;) {
+		ucx_log_flush();
+		ucx_task_delay(1);
+	}
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(bench, DEFAULT_STACK_SIZE);
+	ucx_task_add(logger, DEFAULT_STACK_SIZE);
+	ucx_task_priority(1, TASK_LOW_PRIO);
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
@@ -0,0 +1,115 @@
+#include <ucx.h>
+
+/*
+ * heap fragmentation stress. random sized blocks are allocated and freed in
+ * random order, timing each call. the heap footprint (address range spanned
+ * by the blocks) is compared to the peak of live data, and the largest block
+ * that can be allocated is measured before and after the churn. build the
+ * kernel with ALLOCATOR=-DALT_ALLOCATOR or ALLOCATOR=-DTLSF_ALLOCATOR to
+ * compare the allocators.
+ */
+
+#define SLOTS		256
+#define ROUNDS		20000
+
+void *slot[SLOTS];
+uint32_t size[SLOTS];
+
+uint32_t largest(void)
+{
+	uint32_t lo = 0, hi = (uint32_t)1 << 24, mid;
+	void *p;
+
+	while (lo < hi) {
+		mid = (lo + hi + 1) / 2;
+		p = malloc(mid);
+		if (p) {
+			free(p);
+			lo = mid;
+		} else {
+			hi = mid - 1;
+		}
+	}
+
+	return lo;
+}
+
+uint32_t block_size(void)
+{
+	if (random() % 16)
+		return (random() % 120) + 8;
+	else
+		return (random() % 2048) + 128;
+}
+
+void bench(void)
+{
+	uint32_t i, k, us, total = 0, max = 0, ops = 0, failed = 0;
+	uint32_t live = 0, peak = 0;
+	size_t low = (size_t)-1, high = 0;
+	uint64_t t;
+
+#if defined(TLSF_ALLOCATOR)
+	printf("allocator: tlsf\n");
+#elif defined(ALT_ALLOCATOR)
+	printf("allocator: first-fit (alt)\n");
+#else
+	printf("allocator: first-fit\n");
+#endif
+	printf("largest block (before): %d bytes\n", largest());
+
+	srand(1234);
+	for (i = 0; i < ROUNDS; i++) {
+		k = random() % SLOTS;
+		if (!slot[k])
+			size[k] = block_size();
+		t = _read_us();
+		if (slot[k]) {
+			free(slot[k]);
+			slot[k] = 0;
+			live -= size[k];
+		} else {
+			slot[k] = malloc(size[k]);
+			if (!slot[k])
+				failed++;
+		}
+		us = _read_us() - t;
+
+		if (slot[k]) {
+			live += size[k];
+			if (live > peak)
+				peak = live;
+			if ((size_t)slot[k] < low)
+				low = (size_t)slot[k];
+			if ((size_t)slot[k] + size[k] > high)
+				high = (size_t)slot[k] + size[k];
+		}
+		total += us;
+		if (us > max)
+			max = us;
+		ops++;
+	}
+
+	printf("ops: %d, failed: %d, time: %d us, max: %d us\n", ops, failed, total, max);
+	printf("peak live data: %d bytes, heap footprint: %d bytes\n", peak, high - low);
+	printf("largest block (fragmented): %d bytes\n", largest());
+
+	for (k = 0; k < SLOTS; k++) {
+		if (slot[k])
+			free(slot[k]);
+		slot[k] = 0;
+	}
+	printf("largest block (after): %d bytes\n", largest());
+	printf("done.\n");
+
+	for (;;)
+		ucx_task_yield();
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(bench, DEFAULT_STACK_SIZE);
+
+	// start UCX/OS, cooperative mode
+	return 0;
+}
@@ -0,0 +1,80 @@
+#include <ucx.h>
+
+/*
+ * memory functions throughput, for a range of block sizes. buffers are word
+ * aligned, and memcpy() is also measured with a misaligned source. results
+ * are given in bytes per microsecond and, if the core clock is known (F_CPU),
+ * in bytes per cycle. the kernel runs in cooperative mode, so the timer
+ * interrupt does not interfere with the measurement.
+ */
+
+#define MAX_SIZE	4096
+#define BYTES		(256 * 1024)
+
+enum {MEMCPY, MEMCPY_MISALIGNED, MEMMOVE, MEMSET, MEMCMP, TESTS};
+
+const char *name[TESTS] = {
+	"memcpy", "memcpy (misaligned)", "memmove", "memset", "memcmp"
+};
+
+size_t src_buf[MAX_SIZE / sizeof(size_t) + 1];
+size_t dst_buf[MAX_SIZE / sizeof(size_t) + 1];
+volatile int32_t sink;
+
+uint32_t run(int32_t test, uint32_t size)
+{
+	char *src = (char *)src_buf, *dst = (char *)dst_buf;
+	uint32_t i, rounds = BYTES / size;
+	uint64_t t;
+
+	memcpy(dst_buf, src_buf, sizeof(dst_buf));
+	t = _read_us();
+	for (i = 0; i < rounds; i++) {
+		switch (test) {
+		case MEMCPY: memcpy(dst, src, size); break;
+		case MEMCPY_MISALIGNED: memcpy(dst, src + 1, size); break;
+		case MEMMOVE: memmove(dst + sizeof(size_t), dst, size - sizeof(size_t)); break;
+		case MEMSET: memset(dst, i, size); break;
+		case MEMCMP: sink = memcmp(dst, src, size); break;
+		}
+	}
+
+	return _read_us() - t;
+}
+
+void bench(void)
+{
+	uint32_t size, us, bytes;
+	int32_t test;
+
+	memset(src_buf, 0x55, sizeof(src_buf));
+	memset(dst_buf, 0x55, sizeof(dst_buf));
+
+	for (test = 0; test < TESTS; test++) {
+		for (size = 16; size <= MAX_SIZE; size <<= 2) {
+			bytes = (BYTES / size) * size;
+			us = run(test, size);
+			if (!us)
+				us = 1;
+			printf("%s, %d bytes: %d.%02d bytes/us", name[test], size,
+				bytes / us, (bytes % us) * 100 / us);
+#ifdef F_CPU
+			printf(", %d.%02d bytes/cycle", bytes / (us * (F_CPU / 1000000)),
+				bytes * 100 / (us * (F_CPU / 1000000)) % 100);
+#endif
+			printf("\n");
+		}
+	}
+	printf("done.\n");
+
+	for (;;)
+		ucx_task_yield();
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(bench, DEFAULT_STACK_SIZE);
+
+	// start UCX/OS, cooperative mode
+	return 0;
+}
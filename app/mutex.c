@@ -1,24 +1,24 @@
 #include <ucx.h>
 
-struct sem_s *mutex;
+struct mutex_s *mutex;
 
 void task_a(void)
 {
 	for (;;) {
-		ucx_sem_wait(mutex);
+		ucx_mutex_lock(mutex);
 		printf("hello from task A, id %d\n", ucx_task_id());
 		printf("this is still task A!\n");
-		ucx_sem_signal(mutex);
+		ucx_mutex_unlock(mutex);
 	}
 }
 
 void task_b(void)
 {
 	for (;;) {
-		ucx_sem_wait(mutex);
+		ucx_mutex_lock(mutex);
 		printf("hello from task B, id %d\n", ucx_task_id());
 		printf("this is still task B!\n");
-		ucx_sem_signal(mutex);
+		ucx_mutex_unlock(mutex);
 	}
 }
 
@@ -27,7 +27,7 @@ int32_t app_main(void)
 	ucx_task_add(task_a, DEFAULT_STACK_SIZE);
 	ucx_task_add(task_b, DEFAULT_STACK_SIZE);
 
-	mutex = ucx_sem_create(2, 1);
+	mutex = ucx_mutex_create();
 	
 	return 1;
 }
@@ -0,0 +1,100 @@
+#include <ucx.h>
+
+/*
+ * priority inversion. a low priority task holds a lock for a while, two
+ * normal priority tasks keep the processor busy and a critical task takes
+ * the lock periodically. the time the critical task waits for the lock is
+ * measured with a semaphore used as a lock (no priority inheritance) and
+ * with a mutex, which lends the critical priority to the low priority task.
+ */
+
+#define HOLD		20000		/* processor time holding the lock, in us */
+#define ROUNDS		20
+
+struct sem_s *sem;
+struct mutex_s *mutex;
+volatile uint32_t use_mutex;
+
+/* keeps the processor busy, for some time of its own */
+void work(uint32_t us)
+{
+	struct task_stats_s stats;
+	uint64_t start;
+
+	ucx_task_stats(ucx_task_id(), &stats);
+	start = stats.run_time;
+	do {
+		ucx_task_stats(ucx_task_id(), &stats);
+	} while (stats.run_time - start < us);
+}
+
+void lock(void)
+{
+	if (use_mutex)
+		ucx_mutex_lock(mutex);
+	else
+		ucx_sem_wait(sem);
+}
+
+void unlock(void)
+{
+	if (use_mutex)
+		ucx_mutex_unlock(mutex);
+	else
+		ucx_sem_signal(sem);
+}
+
+void task_low(void)
+{
+	for (;;) {
+		lock();
+		work(HOLD);
+		unlock();
+		ucx_task_yield();
+	}
+}
+
+void task_busy(void)
+{
+	for (;;)
+		work(HOLD);
+}
+
+void task_crit(void)
+{
+	uint32_t i, wait, total, max;
+	uint64_t t;
+
+	for (;;) {
+		total = max = 0;
+		for (i = 0; i < ROUNDS; i++) {
+			ucx_task_delay(5);
+			t = _read_us();
+			lock();
+			wait = _read_us() - t;
+			unlock();
+			total += wait;
+			if (wait > max)
+				max = wait;
+		}
+		printf("%s: lock wait avg %d us, max %d us\n",
+			use_mutex ? "mutex    " : "semaphore", total / ROUNDS, max);
+		use_mutex = !use_mutex;
+	}
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(task_low, DEFAULT_STACK_SIZE);
+	ucx_task_add(task_busy, DEFAULT_STACK_SIZE);
+	ucx_task_add(task_busy, DEFAULT_STACK_SIZE);
+	ucx_task_add(task_crit, DEFAULT_STACK_SIZE);
+	ucx_task_priority(0, TASK_LOW_PRIO);
+	ucx_task_priority(3, TASK_CRIT_PRIO);
+
+	sem = ucx_sem_create(4, 1);
+	mutex = ucx_mutex_create();
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
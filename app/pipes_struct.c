@@ -35,8 +35,7 @@ void task0(void)
 	struct data1_s *ptr = (struct data1_s *)&data;
 
 	while (1) {
-		while (ucx_pipe_size(pipe1) < sizeof(struct data1_s));
-		s = ucx_pipe_read(pipe1, data, ucx_pipe_size(pipe1));
+		s = ucx_pipe_read(pipe1, data, sizeof(struct data1_s));
 		printf("pipe (%d): %s %ld %d\n", s, ptr->v, ptr->a, ptr->b);
 	}
 }
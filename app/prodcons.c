@@ -1,38 +1,46 @@
 #include <ucx.h>
 
 #define N 10
+#define ITEMS 1000
 
 struct sem_s *empty, *full, *mutex;
-int32_t in = 0, out = 0, buffer[N];
+int32_t in = 0, out = 0;
+uint32_t buffer[N];
 
 void producer(void)
 {
-	int32_t item;
-
 	for (;;) {
-		item = random();
 		ucx_sem_wait(empty);
 		ucx_sem_wait(mutex);
-		buffer[in] = item;
-		printf("\nproducer %d putting at %ld (%ld)", ucx_task_id(), in, item);
+		buffer[in] = (uint32_t)_read_us();
 		in = (in + 1) % N;
 		ucx_sem_signal(mutex);
-		ucx_sem_signal(full);
+		ucx_sem_signal_preempt(full);
 	}
 }
 
 void consumer(void)
 {
-	int32_t item;
+	uint32_t item, latency, total = 0, max = 0, count = 0;
 
 	for (;;) {
 		ucx_sem_wait(full);
 		ucx_sem_wait(mutex);
 		item = buffer[out];
-		printf("\nconsumer %d getting from %ld (%ld)", ucx_task_id(), out, item);
 		out = (out + 1) % N;
 		ucx_sem_signal(mutex);
 		ucx_sem_signal(empty);
+
+		latency = (uint32_t)_read_us() - item;
+		total += latency;
+		if (latency > max)
+			max = latency;
+
+		if (++count == ITEMS) {
+			printf("consumer %d: %d items, latency avg %d us, max %d us\n",
+				ucx_task_id(), count, total / count, max);
+			total = max = count = 0;
+		}
 	}
 }
 
@@ -41,10 +49,12 @@ int32_t app_main(void)
 	ucx_task_add(producer, DEFAULT_STACK_SIZE);
 	ucx_task_add(consumer, DEFAULT_STACK_SIZE);
 	ucx_task_add(consumer, DEFAULT_STACK_SIZE);
+	ucx_task_priority(1, TASK_HIGH_PRIO);
+	ucx_task_priority(2, TASK_HIGH_PRIO);
 
 	empty = ucx_sem_create(3, N);
 	full = ucx_sem_create(3, 0);
 	mutex = ucx_sem_create(3, 1);
-	
+
 	return 1;
 }
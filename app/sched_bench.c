@@ -0,0 +1,60 @@
+#include <ucx.h>
+
+/*
+ * context switch latency, as the number of tasks grows. only two tasks are
+ * ready, all others are suspended. the kernel runs in cooperative mode, so
+ * the timer interrupt does not interfere with the measurement.
+ */
+
+#define ROUNDS		10000
+#define MAX_TASKS	64
+
+void filler(void)
+{
+	ucx_task_suspend(ucx_task_id());
+	
+	for (;;);
+}
+
+void partner(void)
+{
+	for (;;)
+		ucx_task_yield();
+}
+
+void bench(void)
+{
+	uint32_t i, n, us;
+	uint64_t t;
+
+	for (n = 2; n <= MAX_TASKS; n *= 2) {
+		while (ucx_task_count() < n)
+			ucx_task_add(filler, DEFAULT_STACK_SIZE);
+		
+		/* let new tasks suspend themselves */
+		for (i = 0; i < n; i++)
+			ucx_task_yield();
+
+		t = _read_us();
+		for (i = 0; i < ROUNDS; i++)
+			ucx_task_yield();
+		us = _read_us() - t;
+
+		printf("tasks: %d, switches: %d, time: %d us, %d ns/switch\n",
+			n, ROUNDS * 2, us, us * 1000 / (ROUNDS * 2));
+	}
+	
+	printf("done.\n");
+	
+	for (;;)
+		ucx_task_yield();
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(bench, DEFAULT_STACK_SIZE);
+	ucx_task_add(partner, DEFAULT_STACK_SIZE);
+
+	// start UCX/OS, cooperative mode
+	return 0;
+}
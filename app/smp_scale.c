@@ -0,0 +1,79 @@
+#include <ucx.h>
+
+/*
+ * scaling of CPU bound tasks as harts are added. the same fixed amount of
+ * work (WORKERS tasks, WORK iterations each) is timed with the workers
+ * allowed to run on 1, 2 and 4 harts (up to NCPU, through their affinity),
+ * and the speedup of each round over the 1 hart round is printed. build the
+ * kernel and the application with SMP = -DNCPU=4 and run on the riscv32-qemu
+ * port with 'make run_riscv32' (qemu -smp 4), or on the host port (where the
+ * speedup is bounded by the number of host cores).
+ */
+
+#define WORKERS		4
+#define WORK		20000000
+
+struct sem_s *go, *done;
+
+void worker(void)
+{
+	volatile uint32_t i, x;
+
+	for (;;) {
+		ucx_sem_wait(go);
+		for (i = 0, x = 0; i < WORK; i++)
+			x += i;
+		ucx_sem_signal(done);
+	}
+}
+
+/* runs the work on the harts in mask, returns the elapsed time in us */
+uint64_t round_run(uint32_t mask)
+{
+	uint64_t start;
+	uint32_t i;
+
+	for (i = 0; i < WORKERS; i++)
+		ucx_task_affinity(i, mask);
+
+	start = _read_us();
+	for (i = 0; i < WORKERS; i++)
+		ucx_sem_signal(go);
+	for (i = 0; i < WORKERS; i++)
+		ucx_sem_wait(done);
+
+	return _read_us() - start;
+}
+
+void report(void)
+{
+	uint64_t elapsed, base = 0;
+	uint32_t harts;
+
+	for (harts = 1; harts <= NCPU; harts <<= 1) {
+		elapsed = round_run(0xffffffff >> (32 - harts));
+		if (harts == 1)
+			base = elapsed;
+		printf("%d harts: %d ms, speedup %d.%02d\n", harts,
+			(uint32_t)(elapsed / 1000), (uint32_t)(base / elapsed),
+			(uint32_t)(base * 100 / elapsed % 100));
+	}
+
+	for (;;)
+		ucx_task_delay(1000);
+}
+
+int32_t app_main(void)
+{
+	uint32_t i;
+
+	go = ucx_sem_create(WORKERS, 0);
+	done = ucx_sem_create(WORKERS, 0);
+
+	for (i = 0; i < WORKERS; i++)
+		ucx_task_add(worker, DEFAULT_STACK_SIZE);
+	ucx_task_add(report, DEFAULT_STACK_SIZE);
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
@@ -0,0 +1,67 @@
+#include <ucx.h>
+
+/*
+ * stack usage report. tasks with different stack needs run for a while,
+ * then the high water mark of each stack is printed, along with a suggested
+ * stack size, to be used instead of DEFAULT_STACK_SIZE.
+ */
+
+uint32_t depth(uint32_t n)
+{
+	volatile char frame[32];
+
+	frame[0] = n;
+	if (n == 0)
+		return frame[0];
+
+	return depth(n - 1) + frame[0];
+}
+
+void task0(void)
+{
+	for (;;)
+		ucx_task_yield();
+}
+
+void task1(void)
+{
+	char buf[128];
+
+	for (;;) {
+		sprintf(buf, "task %d, ticks %d", ucx_task_id(), ucx_ticks());
+		ucx_task_yield();
+	}
+}
+
+void task2(void)
+{
+	for (;;) {
+		depth(16);
+		ucx_task_yield();
+	}
+}
+
+void task3(void)
+{
+	uint16_t i;
+
+	for (i = 0; i < 100; i++)
+		ucx_task_delay(1);
+
+	ucx_task_stack_report();
+	printf("\ntask 2 uses %d bytes of stack\n", ucx_task_stack_usage(2));
+
+	for (;;)
+		ucx_task_yield();
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(task0, DEFAULT_STACK_SIZE);
+	ucx_task_add(task1, DEFAULT_STACK_SIZE);
+	ucx_task_add(task2, DEFAULT_STACK_SIZE);
+	ucx_task_add(task3, DEFAULT_STACK_SIZE);
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
@@ -0,0 +1,146 @@
+#include <ucx.h>
+#include <fixed.h>
+
+/*
+ * formatted output test. snprintf() results are checked against the expected
+ * strings, including 64 bit, padding, precision, fixed point and float
+ * conversions and output truncation. the time taken to print 64 bit counters
+ * is compared to a conversion that divides by ten for every digit.
+ */
+
+#define ROUNDS		1000
+
+uint32_t tests, errors;
+
+void check(const char *expected, const char *fmt, ...)
+{
+	char buf[64];
+	va_list args;
+
+	va_start(args, fmt);
+	vsnprintf(buf, sizeof(buf), fmt, args);
+	va_end(args);
+
+	tests++;
+	if (strcmp(buf, expected)) {
+		errors++;
+		printf("error: format \"%s\", got \"%s\", expected \"%s\"\n", fmt, buf, expected);
+	}
+}
+
+void test_integers(void)
+{
+	check("0", "%d", 0);
+	check("   42|42   |", "%5d|%-5d|", 42, 42);
+	check("-0042", "%05d", -42);
+	check("+7 7", "%+d% d", 7, 7);
+	check("005|    -005|", "%.3d|%8.3d|", 5, -5);
+	check("||", "|%.0d|", 0);
+	check("   7|7   |", "%*d|%-*d|", 4, 7, 4, 7);
+	check("-2147483648", "%ld", (long)-2147483647 - 1);
+	check("4294967295", "%lu", 4294967295UL);
+	check("-9223372036854775808", "%lld", (long long)-9223372036854775807LL - 1);
+	check("18446744073709551615", "%llu", 18446744073709551615ULL);
+	check("1000000000000", "%llu", 1000000000000ULL);
+	check("123456789abcdef", "%llx", 0x123456789abcdefULL);
+	check("BEEF 0000dead", "%X %08x", (uint32_t)0xbeef, (uint32_t)0xdead);
+	check("10 777", "%o %lo", 8, 511UL);
+	check("1 -1", "%hhu %hd", 257, -1);
+	check("123", "%zu", (size_t)123);
+}
+
+void test_strings(void)
+{
+	check("abc|  abc|abc  |ab|", "%s|%5s|%-5s|%.2s|", "abc", "abc", "abc", "abc");
+	check("x  |  x|%", "%-3c|%3c|%%", 'x', 'x');
+	check("<NULL>", "%s", (char *)0);
+}
+
+void test_fractions(void)
+{
+	check("1.500000", "%f", 1.5);
+	check("3.142 -3.142", "%.3f %.3f", 3.14159, -3.14159);
+	check("1234.57", "%.2f", 1234.5678);
+	check("10000000000", "%.0f", 1e10);
+	check("0.001", "%.3f", 0.001);
+	check("1.00", "%.2f", 0.999);
+	check("  2.50|2.50  |002.50", "%6.2f|%-6.2f|%06.2f", 2.5, 2.5, 2.5);
+	check("2.50", "%.*f", 2, 2.5);
+	check("1.500000", "%k", fix_val(1.5));
+	check("-0.25", "%.2k", fix_val(-0.25));
+	check("3.1416", "%.4k", fix_val(3.14159));
+}
+
+void test_truncation(void)
+{
+	char buf[8];
+	int32_t n;
+
+	tests += 3;
+	n = snprintf(buf, 5, "%d", 123456);
+	if (n != 6 || strcmp(buf, "1234"))
+		errors++;
+	buf[0] = 'z';
+	n = snprintf(buf, 0, "%s", "abc");
+	if (n != 3 || buf[0] != 'z')
+		errors++;
+	n = snprintf(buf, sizeof(buf), "%s", "abcdefghij");
+	if (n != 10 || strcmp(buf, "abcdefg"))
+		errors++;
+}
+
+/* reference conversion, dividing by ten for every digit */
+void utoa_div(uint64_t v, char *s)
+{
+	char tmp[24];
+	int32_t i = 0;
+
+	do {
+		tmp[i++] = '0' + v % 10;
+		v /= 10;
+	} while (v);
+	while (i > 0)
+		*s++ = tmp[--i];
+	*s = '\0';
+}
+
+void bench(void)
+{
+	char buf[32];
+	uint64_t t, v = 1234567890123ULL;
+	uint32_t i, us_div, us_fmt;
+
+	t = _read_us();
+	for (i = 0; i < ROUNDS; i++)
+		utoa_div(v + i, buf);
+	us_div = _read_us() - t;
+
+	t = _read_us();
+	for (i = 0; i < ROUNDS; i++)
+		snprintf(buf, sizeof(buf), "%llu", v + i);
+	us_fmt = _read_us() - t;
+
+	printf("%d 64 bit counters: divide %d us, snprintf %d us\n", ROUNDS, us_div, us_fmt);
+}
+
+void task(void)
+{
+	test_integers();
+	test_strings();
+	test_fractions();
+	test_truncation();
+	printf("printf: %d tests, %d errors\n", tests, errors);
+	bench();
+	printf("done.\n");
+
+	for (;;)
+		ucx_task_yield();
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(task, DEFAULT_STACK_SIZE);
+
+	// start UCX/OS, cooperative mode
+	return 0;
+}
@@ -0,0 +1,171 @@
+#include <ucx.h>
+
+/*
+ * string functions test. strlen(), strchr(), strcmp() and strncmp() are
+ * checked against the byte at a time reference versions below, for all
+ * string lengths up to MAX_LEN, all relative alignments, mismatches at every
+ * position and characters with the high bit set. build the kernel with
+ * STRINGS=-DWORD_STRINGS to test the word at a time versions.
+ */
+
+#define MAX_LEN		(4 * sizeof(size_t) + 1)
+#define MAX_ALIGN	sizeof(size_t)
+
+char buf1[MAX_LEN + MAX_ALIGN + 16];
+char buf2[MAX_LEN + MAX_ALIGN + 16];
+const char chars[] = {'a', 'z', '0', (char)0x7f, (char)0x80, (char)0xff};
+uint32_t tests, errors;
+
+int32_t ref_strlen(const char *s1)
+{
+	int32_t n;
+
+	n = 0;
+	while (*s1++)
+		n++;
+
+	return n;
+}
+
+char *ref_strchr(const char *s1, int32_t c)
+{
+	while (*s1 != (char)c)
+		if (!*s1++)
+			return 0;
+
+	return (char *)s1;
+}
+
+int32_t ref_strcmp(const char *s1, const char *s2)
+{
+	while (*s1 == *s2++)
+		if (*s1++ == '\0')
+			return 0;
+
+	return (*s1 - *--s2);
+}
+
+int32_t ref_strncmp(const char *s1, const char *s2, int32_t n)
+{
+	while (--n >= 0 && *s1 == *s2++)
+		if (*s1++ == '\0')
+			return 0;
+
+	return (n < 0 ? 0 : *s1 - *--s2);
+}
+
+void check(int32_t ok, const char *func, int32_t len, int32_t a1, int32_t a2)
+{
+	tests++;
+	if (!ok) {
+		if (errors < 10)
+			printf("%s failed: length %d, alignment %d/%d\n", func, len, a1, a2);
+		errors++;
+	}
+}
+
+/* a string of len characters at s, followed by junk after the terminator */
+void fill(char *s, int32_t len, int32_t seed)
+{
+	int32_t i;
+
+	for (i = 0; i < len; i++)
+		s[i] = 'a' + (seed + i) % 26;
+	s[len] = '\0';
+	for (i = len + 1; i < len + 1 + (int32_t)MAX_ALIGN; i++)
+		s[i] = chars[i % sizeof(chars)];
+}
+
+void test_strlen_strchr(void)
+{
+	int32_t a, len, i, k;
+	char *s;
+	int32_t c;
+
+	for (a = 0; a < (int32_t)MAX_ALIGN; a++) {
+		for (len = 0; len <= (int32_t)MAX_LEN; len++) {
+			s = buf1 + a;
+			fill(s, len, a);
+			check(strlen(s) == ref_strlen(s), "strlen", len, a, 0);
+
+			/* characters at every position, the terminator and absent ones */
+			for (i = 0; i < len; i++) {
+				for (k = 0; k < (int32_t)sizeof(chars); k++) {
+					s[i] = chars[k];
+					c = (unsigned char)chars[k];
+					check(strchr(s, c) == ref_strchr(s, c), "strchr", len, a, i);
+					check(strlen(s) == ref_strlen(s), "strlen", len, a, i);
+				}
+				s[i] = 'a' + (a + i) % 26;
+			}
+			check(strchr(s, 0) == ref_strchr(s, 0), "strchr", len, a, 0);
+			check(strchr(s, '#') == ref_strchr(s, '#'), "strchr", len, a, 0);
+			check(strchr(s, 0x180) == ref_strchr(s, 0x180), "strchr", len, a, 0);
+		}
+	}
+}
+
+void test_strcmp(void)
+{
+	int32_t a1, a2, len, i, k, n;
+	char *s1, *s2, save;
+
+	for (a1 = 0; a1 < (int32_t)MAX_ALIGN; a1++) {
+		for (a2 = 0; a2 < (int32_t)MAX_ALIGN; a2++) {
+			for (len = 0; len <= (int32_t)MAX_LEN; len++) {
+				s1 = buf1 + a1;
+				s2 = buf2 + a2;
+				fill(s1, len, 0);
+				fill(s2, len, 0);
+				check(strcmp(s1, s2) == ref_strcmp(s1, s2), "strcmp", len, a1, a2);
+				for (n = 0; n <= len + 2; n++)
+					check(strncmp(s1, s2, n) == ref_strncmp(s1, s2, n), "strncmp", len, a1, a2);
+
+				/* a mismatch (or an early end) at every position */
+				for (i = 0; i <= len; i++) {
+					save = s2[i];
+					for (k = 0; k < (int32_t)sizeof(chars) + 1; k++) {
+						s2[i] = k < (int32_t)sizeof(chars) ? chars[k] : '\0';
+						check(strcmp(s1, s2) == ref_strcmp(s1, s2), "strcmp", len, a1, a2);
+						check(strcmp(s2, s1) == ref_strcmp(s2, s1), "strcmp", len, a1, a2);
+						for (n = i - 1; n <= i + 1; n++) {
+							check(strncmp(s1, s2, n) == ref_strncmp(s1, s2, n),
+								"strncmp", len, a1, a2);
+							check(strncmp(s2, s1, n) == ref_strncmp(s2, s1, n),
+								"strncmp", len, a1, a2);
+						}
+						check(strncmp(s1, s2, 0x7fffffff) == ref_strncmp(s1, s2, 0x7fffffff),
+							"strncmp", len, a1, a2);
+					}
+					s2[i] = save;
+				}
+			}
+		}
+	}
+}
+
+void task(void)
+{
+#ifdef WORD_STRINGS
+	printf("string functions: word at a time\n");
+#else
+	printf("string functions: byte at a time\n");
+#endif
+	test_strlen_strchr();
+	printf("strlen/strchr: %d tests, %d errors\n", tests, errors);
+	tests = errors = 0;
+	test_strcmp();
+	printf("strcmp/strncmp: %d tests, %d errors\n", tests, errors);
+	printf("done.\n");
+
+	for (;;)
+		ucx_task_yield();
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(task, DEFAULT_STACK_SIZE);
+
+	// start UCX/OS, cooperative mode
+	return 0;
+}
@@ -1,25 +1,34 @@
 #include <ucx.h>
 
+/*
+ * periodic tasks. timer 1 wakes up at absolute times with
+ * ucx_task_delay_until() and timer 2 is made periodic with ucx_task_period(),
+ * so both keep their rate no matter how long printing takes. timer 3 uses a
+ * relative delay, so its wakeup time drifts by the time spent on each loop.
+ */
+
 void timer1(void)
 {
+	uint32_t last_wake = ucx_ticks();
+
 	while (1) {
-		printf("TIMER 1\n");
-		ucx_task_delay(100);
+		printf("TIMER 1 (%d)\n", ucx_ticks());
+		ucx_task_delay_until(&last_wake, 100);
 	}
 }
 
 void timer2(void)
 {
 	while (1) {
-		printf("TIMER 2\n");
-		ucx_task_delay(300);
+		printf("TIMER 2 (%d)\n", ucx_ticks());
+		ucx_task_wait_period();
 	}
 }
 
 void timer3(void)
 {
 	while (1) {
-		printf("TIMER 3\n");
+		printf("TIMER 3 (%d)\n", ucx_ticks());
 		ucx_task_delay(50);
 	}
 }
@@ -36,6 +45,7 @@ int32_t app_main(void)
 	ucx_task_add(timer2, DEFAULT_STACK_SIZE);
 	ucx_task_add(timer3, DEFAULT_STACK_SIZE);
 	ucx_task_add(idle, DEFAULT_STACK_SIZE);
+	ucx_task_period(1, 300);
 
 	// start UCX/OS, preemptive mode
 	return 1;
@@ -0,0 +1,65 @@
+#include <ucx.h>
+
+/*
+ * software timers. a dozen periodic jobs (auto reload timers with periods
+ * of 10 to 120 ticks) share the stack of the timer task, instead of having
+ * a task each. a one shot timer stops half of them after 5 seconds, and a
+ * TIMER_ISR timer counts ticks from the tick interrupt. expirations are
+ * printed every second, with the task count.
+ */
+
+#define JOBS		12
+
+struct timer_s *jobs[JOBS];
+volatile uint32_t count[JOBS], isr_count;
+
+void job(void *arg)
+{
+	count[(size_t)arg]++;
+}
+
+void isr_job(void *arg)
+{
+	isr_count++;
+}
+
+void stop(void *arg)
+{
+	uint32_t i;
+
+	printf("stopping timers 0 to %d\n", JOBS / 2 - 1);
+	for (i = 0; i < JOBS / 2; i++)
+		ucx_timer_stop(jobs[i]);
+}
+
+void report(void)
+{
+	uint32_t i;
+
+	for (;;) {
+		ucx_task_delay(100);
+		printf("%d tasks, isr %d, jobs:", ucx_task_count(), isr_count);
+		for (i = 0; i < JOBS; i++)
+			printf(" %d", count[i]);
+		printf("\n");
+	}
+}
+
+int32_t app_main(void)
+{
+	struct timer_s *timer;
+	size_t i;
+
+	for (i = 0; i < JOBS; i++) {
+		jobs[i] = ucx_timer_create(job, (void *)i, (i + 1) * 10, TIMER_AUTORELOAD);
+		ucx_timer_start(jobs[i]);
+	}
+	timer = ucx_timer_create(stop, 0, 500, TIMER_ONESHOT);
+	ucx_timer_start(timer);
+	timer = ucx_timer_create(isr_job, 0, 1, TIMER_AUTORELOAD | TIMER_ISR);
+	ucx_timer_start(timer);
+	ucx_task_add(report, DEFAULT_STACK_SIZE);
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
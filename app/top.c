@@ -0,0 +1,56 @@
+#include <ucx.h>
+
+/*
+ * cpu usage accounting. tasks with different loads run while a monitor task
+ * prints a table of tasks every second, with their share of the cpu, run time
+ * and context switches.
+ */
+
+void busy(void)
+{
+	for (;;);
+}
+
+void half(void)
+{
+	uint64_t t;
+
+	for (;;) {
+		t = _read_us() + 1000000 / F_TIMER;
+		while (_read_us() < t);
+		ucx_task_delay(1);
+	}
+}
+
+void light(void)
+{
+	for (;;) {
+		ucx_task_delay(10);
+	}
+}
+
+void monitor(void)
+{
+	struct task_stats_s stats;
+
+	for (;;) {
+		ucx_task_delay(F_TIMER);
+		ucx_task_top();
+		if (ucx_task_stats(1, &stats) == ERR_OK)
+			printf("task 1: %llu us, %lu switches, %lu preemptions\n", stats.run_time,
+				(unsigned long)stats.switches, (unsigned long)stats.preemptions);
+	}
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(monitor, DEFAULT_STACK_SIZE);
+	ucx_task_add(busy, DEFAULT_STACK_SIZE);
+	ucx_task_add(half, DEFAULT_STACK_SIZE);
+	ucx_task_add(light, DEFAULT_STACK_SIZE);
+	ucx_task_priority(0, TASK_HIGH_PRIO);
+	ucx_task_priority(1, TASK_LOW_PRIO);
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
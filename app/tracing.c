@@ -0,0 +1,64 @@
+#include <ucx.h>
+
+/*
+ * kernel event tracing. build with tracing enabled (make TRACE=-DTRACE ...),
+ * a producer sends data to a consumer through a pipe, guarded by a semaphore,
+ * and the trace is sent to the console once in a while. the output can be
+ * turned into a timeline with tools/trace2json.py:
+ *
+ *   make debug | tools/trace2json.py > trace.json
+ */
+
+struct pipe_s *pipe;
+struct sem_s *sem;
+
+void producer(void)
+{
+	char buf[16];
+	int32_t i = 0;
+
+	for (;;) {
+		sprintf(buf, "%d", i++);
+		ucx_sem_wait(sem);
+		ucx_pipe_write(pipe, buf, strlen(buf) + 1);
+		ucx_sem_signal(sem);
+		ucx_task_delay(1);
+	}
+}
+
+void consumer(void)
+{
+	char buf[8], *p;
+
+	for (;;) {
+		ucx_pipe_read(pipe, buf, sizeof(buf));
+		p = malloc(sizeof(buf));
+		if (p) {
+			memcpy(p, buf, sizeof(buf));
+			free(p);
+		}
+	}
+}
+
+void dumper(void)
+{
+	for (;;) {
+		ucx_task_delay(50);
+		if (ucx_trace_dump() < 0)
+			printf("tracing is disabled (build with TRACE=-DTRACE)\n");
+	}
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(producer, DEFAULT_STACK_SIZE);
+	ucx_task_add(consumer, DEFAULT_STACK_SIZE);
+	ucx_task_add(dumper, DEFAULT_STACK_SIZE);
+	ucx_task_priority(2, TASK_LOW_PRIO);
+
+	pipe = ucx_pipe_create(32);
+	sem = ucx_sem_create(3, 1);
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
@@ -307,7 +307,7 @@ volatile uint32_t *task_psp, *new_task_psp;
 void SysTick_Handler(void)
 {
 	static uint32_t tval2 = 0, tref = 0;
-	struct tcb_s *task = kcb->task_current->data;
+	struct tcb_s *task = krnl_cpu()->task_current;
 
 	// update microsecond counter
 	if (jf_value() < tref) tval2++;
@@ -317,7 +317,7 @@ void SysTick_Handler(void)
 	// save current PSP, call the scheduler and get new PSP
 	task_psp = &task->context[CONTEXT_PSP];
 	krnl_dispatcher();
-	task = kcb->task_current->data;
+	task = krnl_cpu()->task_current;
 	new_task_psp = &task->context[CONTEXT_PSP];
 	
 	/* trigger PendSV interrupt to perform a task schedule and context switch */
@@ -355,9 +355,88 @@ void _cpu_idle(void)
 {
 }
 
+#ifdef TICKLESS
+/*
+ * tickless idle. runs from the SVC handler, so the SysTick (lowest priority)
+ * can't preempt it. the current SysTick period is stretched up to the last
+ * tick of the sleep (the counter is 24 bits wide, so long sleeps are cut
+ * short) and WFE waits for any interrupt to become pending (SEVONPEND). the
+ * ticks that passed are accounted here (a pending SysTick is cleared) and the
+ * period is restarted, aligned to the original tick boundaries.
+ */
+static void tickless_sleep(void *arg)
+{
+	uint32_t *ticks = arg;
+	uint32_t reload, val, cycles, elapsed, next;
+
+	if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+		*ticks = 0;
+		return;
+	}
+
+	reload = SysTick->LOAD + 1;
+	if (*ticks > SysTick_LOAD_RELOAD_Msk / reload)
+		*ticks = SysTick_LOAD_RELOAD_Msk / reload;
+
+	SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+	val = SysTick->VAL;
+	cycles = val + (*ticks - 1) * reload;
+	SysTick->LOAD = cycles;
+	SysTick->VAL = 0;
+	SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+	SysTick->LOAD = reload - 1;
+
+	SCB->SCR |= SCB_SCR_SEVONPEND_Msk;
+	while (!(SCB->ICSR & (SCB_ICSR_PENDSTSET_Msk | SCB_ICSR_ISRPENDING_Msk)))
+		__WFE();
+
+	if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+		/* slept until the end, the counter is already on the next period */
+		SCB->ICSR = SCB_ICSR_PENDSTCLR_Msk;
+		return;
+	}
+
+	/* woken up early, restart the period at the next tick boundary */
+	SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+	elapsed = cycles - SysTick->VAL;
+	if (elapsed < val) {
+		*ticks = 0;
+		next = val - elapsed;
+	} else {
+		*ticks = (elapsed - val) / reload + 1;
+		next = reload - (elapsed - val) % reload;
+	}
+	SysTick->LOAD = next - 1;
+	SysTick->VAL = 0;
+	SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+	SysTick->LOAD = reload - 1;
+}
+
+/*
+ * tasks run unprivileged, where cpsid is ignored and _di() doesn't mask the
+ * SysTick, so the ticks slept are also accounted here, from the SVC handler,
+ * and none are left for the kernel idle task.
+ */
+static void tickless_idle(void *arg)
+{
+	uint32_t *ticks = arg;
+
+	tickless_sleep(ticks);
+	if (*ticks)
+		krnl_tick(*ticks);
+}
+
+uint32_t _tickless_sleep(uint32_t ticks)
+{
+	syscall(tickless_idle, &ticks);
+
+	return 0;
+}
+#endif
+
 static void _stack_check(void)
 {
-	struct tcb_s *task = kcb->task_current->data;
+	struct tcb_s *task = krnl_cpu()->task_current;
 	uint32_t check = 0x33333333;
 	uint32_t *stack_p = (uint32_t *)task->stack;
 
@@ -370,34 +449,35 @@ static void _stack_check(void)
 		
 }
 
-static struct node_s *_delay_update(struct node_s *node, void *arg)
-{
-	struct tcb_s *task = node->data;
-	
-	if (task->state == TASK_BLOCKED && task->delay > 0) {
-		task->delay--;
-		if (task->delay == 0)
-			task->state = TASK_READY;
-	}
-	
-	return 0;
-}
-
 void _dispatch(void)
 {
-	if (!kcb->tasks->length)
+	if (!kcb->task_count)
 		krnl_panic(ERR_NO_TASKS);
 		
 	_stack_check();
-	list_foreach(kcb->tasks, _delay_update, (void *)0);
+	krnl_tick(1);
 	krnl_schedule();
 }
 
-void _yield(void)
+/* same as the SysTick handler, but a yield is only a tick in cooperative mode */
+static void yield_handler(void *arg)
 {
-	void (*sysfunc)(void *) = (void *)(void *)SysTick_Handler;
+	struct tcb_s *task = krnl_cpu()->task_current;
 
-	syscall(sysfunc, 0);
+	task_psp = &task->context[CONTEXT_PSP];
+	_stack_check();
+	if (kcb->preemptive == 'n')
+		krnl_tick(1);
+	krnl_schedule();
+	task = krnl_cpu()->task_current;
+	new_task_psp = &task->context[CONTEXT_PSP];
+
+	SCB->ICSR |= SCB_ICSR_PENDSVSET_Msk;
+}
+
+void _yield(void)
+{
+	syscall(yield_handler, 0);
 }
 
 void _hardware_init(void)
@@ -450,7 +530,7 @@ void _hardware_init(void)
 void _dispatch_init(jmp_buf env)
 {
 	uint32_t *ctx_p;
-	struct tcb_s *task = kcb->task_current->data;
+	struct tcb_s *task = krnl_cpu()->task_current;
 	
 	ctx_p = (uint32_t *)env;
 	// Set PSP to top of task 0 stack
@@ -463,9 +543,15 @@ void _dispatch_init(jmp_buf env)
 	task->task();
 }
 
-void _di(void)
+/* returns whether interrupts were enabled, so they can be restored */
+int32_t _di(void)
 {
-	asm volatile (	"cpsid i\n\t");
+	uint32_t primask;
+
+	asm volatile (	"mrs %0, primask\n\t"
+			"cpsid i\n\t" : "=r" (primask) : : "memory");
+
+	return !(primask & 1);
 }
 
 void _ei(void)
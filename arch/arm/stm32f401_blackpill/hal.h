@@ -38,7 +38,7 @@ typedef uint32_t jmp_buf[20];
 
 void _enable_interrupts(void);
 void _ei(void);
-void _di(void);
+int32_t _di(void);
 int32_t setjmp(jmp_buf env);
 void longjmp(jmp_buf env, int32_t val);
 void _dispatch_init(jmp_buf env);
@@ -55,6 +55,8 @@ void _hardware_init(void);
 void _timer_enable(void);
 void _timer_disable(void);
 void _interrupt_tick(void);
+void _cpu_idle(void);
+uint32_t _tickless_sleep(uint32_t ticks);
 void _context_init(jmp_buf *ctx, size_t sp, size_t ss, size_t ra);
 
 #define strcpy(dst, src)		ucx_strcpy(dst, src)
@@ -86,6 +88,8 @@ void _context_init(jmp_buf *ctx, size_t sp, size_t ss, size_t ra);
 #define getline(s)			ucx_getline(s)
 #define printf(fmt, ...)		ucx_printf(fmt, ##__VA_ARGS__)
 #define sprintf(out, fmt, ...)		ucx_sprintf(out, fmt, ##__VA_ARGS__)
+#define snprintf(out, n, fmt, ...)	ucx_snprintf(out, n, fmt, ##__VA_ARGS__)
+#define vsnprintf(out, n, fmt, args)	ucx_vsnprintf(out, n, fmt, args)
 
 #define malloc(n)			ucx_malloc(n)
 #define free(n)				ucx_free(n)
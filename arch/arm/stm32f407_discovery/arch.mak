@@ -14,6 +14,10 @@ SERIAL_BR = 115200
 SERIAL_PORT = 1
 # timer interrupt frequency (100 -> 100 ints/s -> 10ms tick time)
 F_TICK = 100
+# tickless idle (comment out to keep the periodic tick while idle)
+TICKLESS = -DTICKLESS
+# assembly memcpy() / memset() (comment out to use the C versions)
+ARCH_MEM = -DARCH_MEMCPY -DARCH_MEMSET
 
 #remove unreferenced functions
 CFLAGS_STRIP = -fdata-sections -ffunction-sections
@@ -23,7 +27,7 @@ LDFLAGS_STRIP = --gc-sections
 #MCU_DEFINES = -mcpu=cortex-m4 -mtune=cortex-m4 -mfloat-abi=hard -mthumb -fsingle-precision-constant -mfpu=fpv4-sp-d16 -Wdouble-promotion
 MCU_DEFINES = -mcpu=cortex-m4 -mtune=cortex-m4 -mfloat-abi=soft -mabi=atpcs -mthumb -fsingle-precision-constant
 C_DEFINES = -D STM32F407xx -D HSE_VALUE=8000000 #-D USB_SERIAL
-CFLAGS = -Wall -O2 -c $(MCU_DEFINES) -mapcs-frame -fverbose-asm -nostdlib -ffreestanding $(C_DEFINES) $(INC_DIRS) -D USART_BAUD=$(SERIAL_BR) -D USART_PORT=$(SERIAL_PORT) -DF_TIMER=${F_TICK} -DLITTLE_ENDIAN $(CFLAGS_STRIP)
+CFLAGS = -Wall -O2 -c $(MCU_DEFINES) -mapcs-frame -fverbose-asm -nostdlib -ffreestanding $(C_DEFINES) $(INC_DIRS) -D USART_BAUD=$(SERIAL_BR) -D USART_PORT=$(SERIAL_PORT) -DF_TIMER=${F_TICK} $(TICKLESS) $(ARCH_MEM) -DLITTLE_ENDIAN $(CFLAGS_STRIP)
 
 LDFLAGS = $(LDFLAGS_STRIP)
 LDSCRIPT = $(ARCH_DIR)/stm32f4_flash.ld
@@ -41,6 +45,7 @@ AR = arm-none-eabi-ar
 hal:
 	$(CC) $(CFLAGS) -o setjmp.o $(ARCH_DIR)/setjmp.s
 	$(CC) $(CFLAGS) -o aeabi.o $(ARCH_DIR)/../../common/aeabi.s
+	$(CC) $(CFLAGS) -o armv7m_mem.o $(ARCH_DIR)/../../common/armv7m_mem.s
 	$(CC) $(CFLAGS) \
 		$(ARCH_DIR)/hal.c \
 		$(ARCH_DIR)/usart.c \
@@ -59,15 +59,16 @@ _enable_interrupts:
 	.global _di	
 _di:
 	mrs	r0, cpsr
-	mov	r1, r0
-	orr	r1, r1, #0x80
+	orr	r1, r0, #0x80
 	msr	cpsr, r1
+	and	r0, r0, #0x80
+	eor	r0, r0, #0x80
 	mov	pc, lr
 
 	.global _ei
 _ei:
 	mrs	r1, cpsr
-	bic	r0, r1, r0
+	bic	r0, r1, #0x80
 	msr	cpsr, r0
 	mov	pc, lr
 
@@ -64,7 +64,7 @@ extern uint32_t _end;			/* Start address of the heap memory, defined in linker s
 #define TIMER_PERIODIC			0x40
 #define TIMER_INTEN			0x20
 #define TIMER_32BIT			0x02
-#define TIMER_ONESHOT			0x01
+#define TIMER_ONESHOT_MODE		0x01
 
 #define TIMCLK				1000000
 
@@ -139,7 +139,7 @@ typedef uint32_t jmp_buf[20];
 
 void _enable_interrupts(void);
 void _ei(void);
-void _di(void);
+int32_t _di(void);
 int32_t setjmp(jmp_buf env);
 void longjmp(jmp_buf env, int32_t val);
 void _dispatch_init(jmp_buf env);
@@ -187,6 +187,8 @@ void _context_init(jmp_buf *ctx, size_t sp, size_t ss, size_t ra);
 #define getline(s)			ucx_getline(s)
 #define printf(fmt, ...)		ucx_printf(fmt, ##__VA_ARGS__)
 #define sprintf(out, fmt, ...)		ucx_sprintf(out, fmt, ##__VA_ARGS__)
+#define snprintf(out, n, fmt, ...)	ucx_snprintf(out, n, fmt, ##__VA_ARGS__)
+#define vsnprintf(out, n, fmt, args)	ucx_vsnprintf(out, n, fmt, args)
 
 #define malloc(n)			ucx_malloc(n)
 #define free(n)				ucx_free(n)
@@ -4,10 +4,12 @@ INC_DIRS  = -I $(ARCH_DIR)
 
 F_CLK=16000000
 SERIAL_BAUDRATE=57600
+# print the stack report this many ticks after boot (uncomment to size task stacks)
+#STACK_REPORT = -DSTACK_REPORT=500
 
 # this is stuff used everywhere - compiler and flags should be declared (ASFLAGS, CFLAGS, LDFLAGS, LD_SCRIPT, CC, AS, LD, DUMP, READ, OBJ and SIZE).
 ASFLAGS = 
-CFLAGS = -c -g -mmcu=atmega328p -Wall -Os -fno-inline-small-functions -Wno-pointer-to-int-cast -Wno-int-to-pointer-cast -Wno-main -fomit-frame-pointer -D F_CPU=$(F_CLK) -D USART_BAUD=$(SERIAL_BAUDRATE) $(INC_DIRS) -D UNKNOWN_HEAP
+CFLAGS = -c -g -mmcu=atmega328p -Wall -Os -fno-inline-small-functions -Wno-pointer-to-int-cast -Wno-int-to-pointer-cast -Wno-main -fomit-frame-pointer -D F_CPU=$(F_CLK) -D USART_BAUD=$(SERIAL_BAUDRATE) $(INC_DIRS) -D UNKNOWN_HEAP $(STACK_REPORT)
 ARFLAGS = r
 LDFLAGS = -g -mmcu=atmega328p -Wall -Os -fno-inline-small-functions -Wno-pointer-to-int-cast -Wno-int-to-pointer-cast -Wno-main -fomit-frame-pointer -D F_CPU=$(F_CLK) -D USART_BAUD=$(SERIAL_BAUDRATE) $(INC_DIRS) -D UNKNOWN_HEAP
 LDSCRIPT = 
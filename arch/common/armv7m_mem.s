@@ -0,0 +1,102 @@
+/*
+ * memcpy() and memset() for ARMv7-M (Cortex-M3/M4). when the pointers are
+ * (or can be) word aligned, data is moved in 16 byte LDM/STM bursts, then
+ * in words and bytes. misaligned copies are done bytewise. enabled with
+ * -DARCH_MEMCPY -DARCH_MEMSET, which leave out the C versions in libc.c.
+ */
+
+	.syntax unified
+	.thumb
+
+/* void *ucx_memcpy(void *dst, const void *src, uint32_t n) */
+	.text
+	.balign 4
+	.globl ucx_memcpy
+	.thumb_func
+ucx_memcpy:
+	push	{r0, r4-r7, lr}
+	eor	r3, r0, r1
+	tst	r3, #3
+	bne	.Lcpy_bytes
+.Lcpy_align:
+	tst	r0, #3
+	beq	.Lcpy_aligned
+	cmp	r2, #0
+	beq	.Lcpy_done
+	ldrb	r3, [r1], #1
+	strb	r3, [r0], #1
+	subs	r2, r2, #1
+	b	.Lcpy_align
+.Lcpy_aligned:
+	subs	r2, r2, #16
+	blo	.Lcpy_words
+.Lcpy_burst:
+	ldmia	r1!, {r3-r6}
+	stmia	r0!, {r3-r6}
+	subs	r2, r2, #16
+	bhs	.Lcpy_burst
+.Lcpy_words:
+	adds	r2, r2, #16
+.Lcpy_word:
+	subs	r2, r2, #4
+	blo	.Lcpy_tail
+	ldr	r3, [r1], #4
+	str	r3, [r0], #4
+	b	.Lcpy_word
+.Lcpy_tail:
+	adds	r2, r2, #4
+.Lcpy_bytes:
+	cmp	r2, #0
+	beq	.Lcpy_done
+	ldrb	r3, [r1], #1
+	strb	r3, [r0], #1
+	subs	r2, r2, #1
+	b	.Lcpy_bytes
+.Lcpy_done:
+	pop	{r0, r4-r7, pc}
+
+/* void *ucx_memset(void *s, int32_t c, uint32_t n) */
+	.text
+	.balign 4
+	.globl ucx_memset
+	.thumb_func
+ucx_memset:
+	push	{r0, r4-r7, lr}
+	and	r1, r1, #0xff
+	orr	r1, r1, r1, lsl #8
+	orr	r1, r1, r1, lsl #16
+.Lset_align:
+	tst	r0, #3
+	beq	.Lset_aligned
+	cmp	r2, #0
+	beq	.Lset_done
+	strb	r1, [r0], #1
+	subs	r2, r2, #1
+	b	.Lset_align
+.Lset_aligned:
+	mov	r3, r1
+	mov	r4, r1
+	mov	r5, r1
+	subs	r2, r2, #16
+	blo	.Lset_words
+.Lset_burst:
+	stmia	r0!, {r1, r3-r5}
+	subs	r2, r2, #16
+	bhs	.Lset_burst
+.Lset_words:
+	adds	r2, r2, #16
+.Lset_word:
+	subs	r2, r2, #4
+	blo	.Lset_tail
+	str	r1, [r0], #4
+	b	.Lset_word
+.Lset_tail:
+	adds	r2, r2, #4
+.Lset_bytes:
+	cmp	r2, #0
+	beq	.Lset_done
+	strb	r1, [r0], #1
+	subs	r2, r2, #1
+	b	.Lset_bytes
+.Lset_done:
+	pop	{r0, r4-r7, pc}
@@ -0,0 +1,40 @@
+# this is stuff specific to this architecture
+ARCH_DIR = $(SRC_DIR)/arch/$(ARCH)
+INC_DIRS  = -I $(ARCH_DIR)
+
+# timer interrupt frequency (100 -> 100 ints/s -> 10ms tick time)
+F_TICK = 100
+# tickless idle (comment out to keep the periodic tick while idle)
+TICKLESS = -DTICKLESS
+# heap size (static array in the HAL)
+HEAP_SIZE = 16777216
+# harts running tasks, one thread each (uncomment for SMP, also pass it to the application build)
+#SMP = -DNCPU=2
+# print the stack report this many ticks after boot (uncomment to size task stacks)
+#STACK_REPORT = -DSTACK_REPORT=500
+
+# this is stuff used everywhere - compiler and flags should be declared (ASFLAGS, CFLAGS, LDFLAGS, LD_SCRIPT, CC, AS, LD, DUMP, READ, OBJ and SIZE).
+ASFLAGS =
+CFLAGS = -Wall -O2 -c -ffreestanding -fno-pie -fno-stack-protector -fomit-frame-pointer $(INC_DIRS) -DF_CPU=1000000000 -DF_TIMER=${F_TICK} -DHOST_HEAP_SIZE=$(HEAP_SIZE) $(TICKLESS) $(SMP) $(STACK_REPORT) -DLITTLE_ENDIAN
+ARFLAGS = r
+
+LDFLAGS = -pthread -no-pie -Wl,--defsym,_heap_size=$(HEAP_SIZE)
+
+CC = gcc
+AS = as
+LD = gcc
+DUMP = objdump
+READ = readelf
+OBJ = objcopy
+SIZE = size
+AR = ar
+
+hal:
+	$(AS) $(ASFLAGS) -o context.o $(ARCH_DIR)/context.s
+	$(CC) $(CFLAGS) \
+		$(ARCH_DIR)/hal.c \
+		$(ARCH_DIR)/../../common/ieee754.c \
+		$(ARCH_DIR)/../../common/math.c
+
+run_host:
+	$(BUILD_TARGET_DIR)/image.elf
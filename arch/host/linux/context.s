@@ -0,0 +1,51 @@
+# file:          context.s
+# description:   setjmp() / longjmp() for the hosted Linux (x86_64) target
+#
+# jmp_buf layout: rbx, rbp, r12, r13, r14, r15, rsp, return address
+
+	.text
+
+	.globl	_host_setjmp
+	.type	_host_setjmp, @function
+_host_setjmp:
+	movq	%rbx, 0(%rdi)
+	movq	%rbp, 8(%rdi)
+	movq	%r12, 16(%rdi)
+	movq	%r13, 24(%rdi)
+	movq	%r14, 32(%rdi)
+	movq	%r15, 40(%rdi)
+	leaq	8(%rsp), %rdx
+	movq	%rdx, 48(%rdi)
+	movq	(%rsp), %rdx
+	movq	%rdx, 56(%rdi)
+	xorl	%eax, %eax
+	ret
+	.size	_host_setjmp, .-_host_setjmp
+
+	.globl	_host_longjmp
+	.type	_host_longjmp, @function
+_host_longjmp:
+	movl	%esi, %eax
+	testl	%eax, %eax
+	jnz	1f
+	movl	$1, %eax		# longjmp(env, 0) returns 1 from setjmp()
+1:
+	movq	0(%rdi), %rbx
+	movq	8(%rdi), %rbp
+	movq	16(%rdi), %r12
+	movq	24(%rdi), %r13
+	movq	32(%rdi), %r14
+	movq	40(%rdi), %r15
+	movq	48(%rdi), %rsp
+	jmp	*56(%rdi)
+	.size	_host_longjmp, .-_host_longjmp
+
+	.globl	_dispatch_init
+	.type	_dispatch_init, @function
+# interrupts (signals) are unmasked by the first task, once the kernel lock is released
+_dispatch_init:
+	movl	$1, %esi
+	jmp	_host_longjmp
+	.size	_dispatch_init, .-_dispatch_init
+
+	.section	.note.GNU-stack,"",@progbits
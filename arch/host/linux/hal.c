@@ -0,0 +1,259 @@
+/* file:          hal.c
+ * description:   hardware abstraction layer for a hosted Linux process
+ * date:          10/2026
+ * author:        Sergio Johann Filho <sergio.johann@acad.pucrs.br>
+ */
+
+#define _GNU_SOURCE
+#include <signal.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <pthread.h>
+#include <hal.h>
+
+/* the heap is a static array, its size is also passed to the linker (_heap_size) */
+uint32_t _heap_start[HOST_HEAP_SIZE / sizeof(uint32_t)] __attribute__ ((aligned(16)));
+
+static sigset_t timer_set;
+
+#if NCPU > 1
+/*
+ * SMP: each hart is a thread, with its own tick (a timer signalling only that
+ * thread). another hart is interrupted with SIGUSR1, masked together with the
+ * tick by _di().
+ */
+static pthread_t harts[NCPU];
+static __thread uint32_t hart;
+static __thread timer_t hart_timer;
+
+/* older C libraries don't name the thread id of a SIGEV_THREAD_ID event */
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id		_sigev_un._tid
+#endif
+
+void main_cpu(void);
+#endif
+
+
+/* libc basic I/O support */
+
+void _putchar(char value)
+{
+	while (write(STDOUT_FILENO, &value, 1) < 0);
+}
+
+int32_t _kbhit(void)
+{
+	struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+
+	return poll(&pfd, 1, 0) > 0;
+}
+
+int32_t _getchar(void)
+{
+	unsigned char c;
+
+	if (read(STDIN_FILENO, &c, 1) != 1)
+		return -1;
+
+	return c;
+}
+
+
+/* timing */
+
+static uint64_t host_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+uint32_t _readcounter(void)
+{
+	return (uint32_t)host_ns();
+}
+
+uint64_t _read_us(void)
+{
+	return host_ns() / 1000;
+}
+
+void _delay_ms(uint32_t msec)
+{
+	_delay_us(msec * 1000);
+}
+
+void _delay_us(uint32_t usec)
+{
+	uint64_t end = _read_us() + usec;
+
+	while (_read_us() < end);
+}
+
+
+/* interrupt management (the timer interrupt is SIGALRM) */
+
+int32_t _interrupt_set(int32_t s)
+{
+	sigset_t old;
+
+	pthread_sigmask(s ? SIG_UNBLOCK : SIG_BLOCK, &timer_set, &old);
+
+	return !sigismember(&old, SIGALRM);
+}
+
+static void timer_handler(int sig)
+{
+	krnl_dispatcher();
+}
+
+#if NCPU > 1
+/* another hart has made a task ready, returning from the handler is enough */
+static void ipi_handler(int sig)
+{
+}
+#endif
+
+void _cpu_idle(void)
+{
+	sigset_t none;
+
+	sigemptyset(&none);
+	sigsuspend(&none);
+}
+
+/* tickless idle: SIGALRM is blocked here, wait for it instead of handling it */
+uint32_t _tickless_sleep(uint32_t ticks)
+{
+	struct itimerval it;
+	uint64_t period = 1000000000ULL / F_TIMER;
+	uint64_t next, now, val;
+	int sig;
+
+	getitimer(ITIMER_REAL, &it);
+	next = host_ns() + it.it_value.tv_sec * 1000000000ULL + it.it_value.tv_usec * 1000ULL;
+	val = it.it_value.tv_sec * 1000000ULL + it.it_value.tv_usec + (ticks - 1) * (period / 1000);
+	it.it_value.tv_sec = val / 1000000;
+	it.it_value.tv_usec = val % 1000000;
+	setitimer(ITIMER_REAL, &it, 0);
+	sigwait(&timer_set, &sig);
+	now = host_ns();
+
+	if (now < next)
+		return 0;
+
+	return (now - next) / period + 1;
+}
+
+void _hardware_init(void)
+{
+	struct sigaction sa;
+
+	sigemptyset(&timer_set);
+	sigaddset(&timer_set, SIGALRM);
+
+	sa.sa_handler = timer_handler;
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = SA_RESTART;
+	sigaction(SIGALRM, &sa, 0);
+#if NCPU > 1
+	sigaddset(&timer_set, SIGUSR1);
+	sa.sa_handler = ipi_handler;
+	sigaction(SIGUSR1, &sa, 0);
+	harts[0] = pthread_self();
+#endif
+}
+
+#if NCPU > 1
+void _timer_enable(void)
+{
+	struct sigevent ev = { 0 };
+	struct itimerspec it;
+
+	ev.sigev_notify = SIGEV_THREAD_ID;
+	ev.sigev_signo = SIGALRM;
+	ev.sigev_notify_thread_id = gettid();
+	timer_create(CLOCK_MONOTONIC, &ev, &hart_timer);
+	it.it_interval.tv_sec = 0;
+	it.it_interval.tv_nsec = 1000000000 / F_TIMER;
+	it.it_value = it.it_interval;
+	timer_settime(hart_timer, 0, &it, 0);
+}
+
+void _timer_disable(void)
+{
+	timer_delete(hart_timer);
+}
+
+/* the tick returns with the kernel lock held, the switched in task unmasks it */
+void _interrupt_tick(void)
+{
+}
+#else
+void _timer_enable(void)
+{
+	struct itimerval it;
+
+	it.it_interval.tv_sec = 0;
+	it.it_interval.tv_usec = 1000000 / F_TIMER;
+	it.it_value = it.it_interval;
+	setitimer(ITIMER_REAL, &it, 0);
+}
+
+void _timer_disable(void)
+{
+	struct itimerval it = { 0 };
+
+	setitimer(ITIMER_REAL, &it, 0);
+}
+
+void _interrupt_tick(void)
+{
+	_ei();
+}
+#endif
+
+#if NCPU > 1
+uint32_t _cpu_id(void)
+{
+	return hart;
+}
+
+void _cpu_notify(uint32_t n)
+{
+	pthread_kill(harts[n], SIGUSR1);
+}
+
+static void *hart_entry(void *arg)
+{
+	hart = (size_t)arg;
+	main_cpu();
+
+	return 0;
+}
+
+/* the other harts start with the signals of hart 0 (the tick and IPI) masked */
+void _cpu_start(void)
+{
+	size_t i;
+
+	for (i = 1; i < NCPU; i++)
+		pthread_create(&harts[i], 0, hart_entry, (void *)i);
+}
+#endif
+
+void _context_init(jmp_buf *ctx, size_t sp, size_t ss, size_t ra)
+{
+	uint64_t *ctx_p;
+
+	ctx_p = (uint64_t *)ctx;
+
+	/* keep the SysV ABI alignment, as if the task was called */
+	ctx_p[CONTEXT_SP] = ((sp + ss) & ~15UL) - 8;
+	ctx_p[CONTEXT_RA] = ra;
+}
@@ -8,14 +8,20 @@ F_CLK=10000000
 SERIAL_BAUDRATE=57600
 # timer interrupt frequency (100 -> 100 ints/s -> 10ms tick time. 0 -> timer0 fixed frequency)
 F_TICK = 100
+# tickless idle (comment out to keep the periodic tick while idle)
+TICKLESS = -DTICKLESS
+# interrupt driven, buffered console output (comment out for polled output)
+CONSOLE = -DCONSOLE_IRQ
+# harts running tasks (uncomment for SMP, 1 to 4, the -smp count of run_riscv32, also pass it to the application build)
+#SMP = -DNCPU=4
 
 #remove unreferenced functions
 CFLAGS_STRIP = -fdata-sections -ffunction-sections
 LDFLAGS_STRIP = --gc-sections
 
 # this is stuff used everywhere - compiler and flags should be declared (ASFLAGS, CFLAGS, LDFLAGS, LD_SCRIPT, CC, AS, LD, DUMP, READ, OBJ and SIZE).
-ASFLAGS = -march=rv32imzicsr -mabi=ilp32 #-fPIC
-CFLAGS = -Wall -march=rv32imzicsr -mabi=ilp32 -O2 -c -mstrict-align -ffreestanding -nostdlib -fomit-frame-pointer $(INC_DIRS) -DF_CPU=${F_CLK} -D USART_BAUD=$(SERIAL_BAUDRATE) -DF_TIMER=${F_TICK} -DLITTLE_ENDIAN $(CFLAGS_STRIP)
+ASFLAGS = -march=rv32imazicsr -mabi=ilp32 #-fPIC
+CFLAGS = -Wall -march=rv32imazicsr -mabi=ilp32 -O2 -c -mstrict-align -ffreestanding -nostdlib -fomit-frame-pointer $(INC_DIRS) -DF_CPU=${F_CLK} -D USART_BAUD=$(SERIAL_BAUDRATE) -DF_TIMER=${F_TICK} $(TICKLESS) $(CONSOLE) $(SMP) -DLITTLE_ENDIAN $(CFLAGS_STRIP)
 ARFLAGS = r
 
 LDFLAGS = -melf32lriscv $(LDFLAGS_STRIP)
@@ -41,4 +47,4 @@ hal:
 run_riscv32:
 	echo "hit Ctrl+a x to quit"
 #	qemu-system-riscv32 -machine virt -nographic -bios $(BUILD_TARGET_DIR)/image.bin -serial mon:stdio
-	qemu-system-riscv32 -smp 2 -machine virt -bios none -kernel $(BUILD_TARGET_DIR)/image.elf -nographic
+	qemu-system-riscv32 -smp 4 -machine virt -bios none -kernel $(BUILD_TARGET_DIR)/image.elf -nographic
@@ -2,11 +2,35 @@
 	.align 2
 
 	.global _entry
+	.weak main_cpu
 _entry:
-	# stop all harts (except 0)
+	# other harts wait for hart 0 (SMP) or sleep
 	csrr	t0, mhartid
 	beq	zero, t0, _boothart0
+
+	# 64KB of boot stack per hart, below the stack of hart 0
+	la	gp, _gp
+	la	sp, _stack
+	slli	t1, t0, 16
+	sub	sp, sp, t1
+	csrw	mstatus, zero
+	csrw	mideleg, zero
+	csrw	medeleg, zero
+	la	t1, _isr
+	csrw	mtvec, t1
+
+	# wake up on a software interrupt (MSI), not taken (MIE=0)
+	li	t1, 0x8
+	csrw	mie, t1
+_parkhart:
 	wfi
+	la	t1, _cpu_release
+	lw	t1, 0(t1)
+	beq	zero, t1, _parkhart
+	la	t1, main_cpu
+	beq	zero, t1, _parkhart
+	jalr	ra, t1, 0
+	j	_parkhart
 	
 _boothart0:
 	la	a3, _sbss
@@ -159,6 +183,6 @@ _dispatch_init:
 	lw    tp, 52(a0)
 	lw    sp, 56(a0)
 	lw    ra, 60(a0)
-	addi  a5, zero, 128
+	li    a5, 0x888
 	csrw  mie, a5
 	ret
@@ -4,16 +4,65 @@
  * author:        Sergio Johann Filho <sergio.johann@acad.pucrs.br>
  */
 
-#include <hal.h>
-#include <lib/libc.h>
+#include <ucx.h>
 
 /* hardware platform dependent stuff */
-void _putchar(char value)		// polled putchar()
+static void uart_putc(char value)	// polled putchar()
 {
 	while (!((NS16550A_UART0_CTRL_ADDR(NS16550A_LSR) & NS16550A_LSR_RI)));
 	NS16550A_UART0_CTRL_ADDR(NS16550A_THR) = value;
 }
 
+#ifdef CONSOLE_IRQ
+/*
+ * buffered console: with interrupts enabled, characters are queued by the
+ * kernel and sent by the UART interrupt handler, a FIFO full at a time. with
+ * interrupts disabled (cooperative mode, interrupt handlers, kernel panic)
+ * the queue is drained and characters are sent by polling.
+ */
+void _putchar(char value)
+{
+	int32_t c;
+
+	if (read_csr(mstatus) & 0x8) {
+		krnl_console_putc(value);
+
+		return;
+	}
+
+	while ((c = krnl_console_getc()) >= 0)
+		uart_putc(c);
+	uart_putc(value);
+}
+
+void _console_tx_start(void)
+{
+	NS16550A_UART0_CTRL_ADDR(NS16550A_IER) |= NS16550A_IER_THRI;
+}
+
+static void uart_tx_isr(void)
+{
+	int32_t i, c;
+
+	if (!(NS16550A_UART0_CTRL_ADDR(NS16550A_LSR) & NS16550A_LSR_RE))
+		return;
+
+	for (i = 0; i < NS16550A_FIFO_SIZE; i++) {
+		c = krnl_console_getc();
+		if (c < 0) {
+			NS16550A_UART0_CTRL_ADDR(NS16550A_IER) &= ~NS16550A_IER_THRI;
+			break;
+		}
+		NS16550A_UART0_CTRL_ADDR(NS16550A_THR) = c;
+	}
+}
+#else
+void _putchar(char value)
+{
+	uart_putc(value);
+}
+#endif
+
 int32_t _kbhit(void)
 {
 	return 0;
@@ -90,6 +139,7 @@ static void uart_init(uint32_t baud)
 	NS16550A_UART0_CTRL_ADDR(NS16550A_DLM) = (divisor >> 8) & 0xff;
 	NS16550A_UART0_CTRL_ADDR(NS16550A_DLL) = divisor & 0xff;
 	NS16550A_UART0_CTRL_ADDR(NS16550A_LCR) = NS16550A_LCR_8BIT;
+	NS16550A_UART0_CTRL_ADDR(NS16550A_FCR) = NS16550A_FCR_ENABLE;
 }
 
 void _cpu_idle(void)
@@ -97,11 +147,65 @@ void _cpu_idle(void)
 	asm volatile ("wfi");
 }
 
+/*
+ * tickless idle: called with interrupts disabled. the timer is programmed
+ * to interrupt on the last tick of the sleep and wfi waits for it (or for
+ * any other enabled interrupt). the timer is rearmed for the next regular
+ * tick and the number of ticks that passed is returned.
+ */
+uint32_t _tickless_sleep(uint32_t ticks)
+{
+	uint64_t period = F_CPU / F_TIMER;
+	uint64_t next, now;
+	uint32_t elapsed;
+
+	next = mtimecmp_r();
+	mtimecmp_w(next + (ticks - 1) * period);
+	_cpu_idle();
+	now = mtime_r();
+
+	if (now < next) {
+		mtimecmp_w(next);
+
+		return 0;
+	}
+
+	elapsed = (now - next) / period + 1;
+	mtimecmp_w(next + elapsed * period);
+
+	return elapsed;
+}
+
 void _irq_handler(uint32_t cause, uint32_t *stack)
 {
 	uint32_t val;
+#ifdef CONSOLE_IRQ
+	uint32_t irq;
+#endif
 	
 	val = read_csr(mcause);
+	/* machine software interrupt, another hart has made a task ready */
+	if (val == 0x80000003) {
+		MSIP(_cpu_id()) = 0;
+
+		return;
+	}
+#ifdef CONSOLE_IRQ
+	/* machine external interrupt */
+	if (val == 0x8000000b) {
+		irq = PLIC_CLAIM;
+		krnl_trace(TRACE_ISR_ENTER, irq);
+		if (irq == UART0_IRQ) {
+			krnl_lock();
+			uart_tx_isr();
+			krnl_unlock();
+		}
+		krnl_trace(TRACE_ISR_EXIT, irq);
+		PLIC_CLAIM = irq;
+
+		return;
+	}
+#endif
 	if (mtime_r() > mtimecmp_r()) {
 		mtimecmp_w(mtime_r() + (F_CPU / F_TIMER));
 		krnl_dispatcher();
@@ -117,17 +221,10 @@ uint32_t _readcounter(void)
 	return MTIME_L;
 }
 
+/* mtime is 64 bits wide and shared by all harts */
 uint64_t _read_us(void)
 {
-	static uint64_t timeref = 0;
-	static uint32_t tval2 = 0, tref = 0;
-
-	if (tref == 0) _readcounter();
-	if (_readcounter() < tref) tval2++;
-	tref = _readcounter();
-	timeref = ((uint64_t)tval2 << 32) + (uint64_t)_readcounter();
-
-	return (timeref / (F_CPU / 1000000));
+	return mtime_r() / (F_CPU / 1000000);
 }
 
 // https://forums.sifive.com/t/timer-and-interrupt/3456/5
@@ -179,10 +276,20 @@ void _hardware_init(void)
 {
 	uart_init(USART_BAUD);
 	mtimecmp_w(mtime_r() + (F_CPU / F_TIMER));
+#ifdef CONSOLE_IRQ
+	PLIC_PRIORITY(UART0_IRQ) = 1;
+	PLIC_THRESHOLD = 0;
+	PLIC_ENABLE = 1 << UART0_IRQ;
+#endif
 }
 
+/*
+ * arms the timer of the calling hart. _hardware_init() runs on hart 0 only,
+ * so with SMP the other harts program their first tick here (from main_cpu()).
+ */
 void _timer_enable(void)
 {
+	mtimecmp_w(mtime_r() + (F_CPU / F_TIMER));
 	asm volatile ("csrs mstatus, 8");
 }
 
@@ -191,9 +298,38 @@ void _timer_disable(void)
 	asm volatile ("csrc mstatus, 8");
 }
 
+/*
+ * with SMP the tick returns with the kernel lock held until the task that
+ * is switched in releases it, so interrupts are kept disabled until then.
+ */
 void _interrupt_tick(void)
 {
+#if NCPU == 1
 	_ei();
+#endif
+}
+
+/*
+ * SMP: other harts wait in the C runtime (with the software interrupt
+ * enabled) until hart 0 sets _cpu_release and interrupts them. they enter
+ * the kernel in main_cpu(). the flag lives in .data, as .bss is cleared by
+ * hart 0 while the other harts may already be reading it.
+ */
+volatile uint32_t _cpu_release __attribute__ ((section(".data"))) = 0;
+
+void _cpu_notify(uint32_t hart)
+{
+	MSIP(hart) = 1;
+}
+
+void _cpu_start(void)
+{
+	uint32_t i;
+
+	_cpu_release = 1;
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	for (i = 1; i < NCPU; i++)
+		_cpu_notify(i);
 }
 
 void _context_init(jmp_buf *ctx, size_t sp, size_t ss, size_t ra)
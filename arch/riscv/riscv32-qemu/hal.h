@@ -61,13 +61,28 @@ extern uint32_t _end;			/* Start address of the heap memory, defined in linker s
 #define NS16550A_LSR_RE  	 	0x20
 #define NS16550A_LSR_RI   		0x40
 #define NS16550A_LSR_EF   		0x80
-
+#define NS16550A_IER_THRI		0x02
+#define NS16550A_FCR_ENABLE		0x07
+#define NS16550A_FIFO_SIZE		16
+
+/* platform level interrupt controller (hart 0, M mode context) */
+#define PLIC_PRIORITY(irq)		(*(volatile uint32_t *)(0x0c000000 + 4 * (irq)))
+#define PLIC_ENABLE			(*(volatile uint32_t *)(0x0c002000))
+#define PLIC_THRESHOLD			(*(volatile uint32_t *)(0x0c200000))
+#define PLIC_CLAIM			(*(volatile uint32_t *)(0x0c200004))
+#define UART0_IRQ			10
+
+/* core local interruptor, timer compare and software interrupt per hart */
 #define MTIME				(*(volatile uint64_t *)(0x0200bff8))
-#define MTIMECMP			(*(volatile uint64_t *)(0x02004000))
+#define MTIMECMP			(*(volatile uint64_t *)(0x02004000 + 8 * _cpu_id()))
 #define MTIME_L				(*(volatile uint32_t *)(0x0200bff8))
 #define MTIME_H				(*(volatile uint32_t *)(0x0200bffc))
-#define MTIMECMP_L			(*(volatile uint32_t *)(0x02004000))
-#define MTIMECMP_H			(*(volatile uint32_t *)(0x02004004))
+#define MTIMECMP_L			(*(volatile uint32_t *)(0x02004000 + 8 * _cpu_id()))
+#define MTIMECMP_H			(*(volatile uint32_t *)(0x02004004 + 8 * _cpu_id()))
+#define MSIP(hart)			(*(volatile uint32_t *)(0x02000000 + 4 * (hart)))
+
+/* hart id, SMP builds run tasks on harts 0 to NCPU - 1 */
+#define _cpu_id()			read_csr(mhartid)
 
 /* hardware dependent C library stuff */
 #define CONTEXT_SP	14
@@ -92,6 +107,11 @@ void _hardware_init(void);
 void _timer_enable(void);
 void _timer_disable(void);
 void _interrupt_tick(void);
+void _cpu_idle(void);
+void _cpu_notify(uint32_t hart);
+void _cpu_start(void);
+uint32_t _tickless_sleep(uint32_t ticks);
+void _console_tx_start(void);
 void _context_init(jmp_buf *ctx, size_t sp, size_t ss, size_t ra);
 
 uint64_t mtime_r(void);
@@ -128,6 +148,8 @@ void mtimecmp_w(uint64_t val);
 #define getline(s)			ucx_getline(s)
 #define printf(fmt, ...)		ucx_printf(fmt, ##__VA_ARGS__)
 #define sprintf(out, fmt, ...)		ucx_sprintf(out, fmt, ##__VA_ARGS__)
+#define snprintf(out, n, fmt, ...)	ucx_snprintf(out, n, fmt, ##__VA_ARGS__)
+#define vsnprintf(out, n, fmt, args)	ucx_vsnprintf(out, n, fmt, args)
 
 #define malloc(n)			ucx_malloc(n)
 #define free(n)				ucx_free(n)
@@ -135,5 +157,7 @@ void mtimecmp_w(uint64_t val);
 #define realloc(p, s)			ucx_realloc(p, s)
 
 void krnl_dispatcher(void);
+void krnl_console_putc(char c);
+int32_t krnl_console_getc(void);
 
 #define DEFAULT_STACK_SIZE	4096
@@ -0,0 +1,5 @@
+/* console output buffer size (a power of 2) */
+#define CONSOLE_BUF_SIZE	256
+
+void krnl_console_putc(char c);
+int32_t krnl_console_getc(void);
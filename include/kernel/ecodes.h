@@ -16,6 +16,9 @@ enum ecodes {
 	ERR_SEM_ALLOC,
 	ERR_SEM_DEALLOC,
 	ERR_EQ_NOTEMPTY,
+	ERR_TIMEOUT,
+	ERR_MUTEX_OWNER,
+	ERR_TASK_RT_LOAD,
 	ERR_UNKNOWN
 };
 
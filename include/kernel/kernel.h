@@ -8,6 +8,24 @@
 /* task states */
 enum {TASK_STOPPED, TASK_READY, TASK_RUNNING, TASK_BLOCKED, TASK_SUSPENDED};
 
+/* ready queue slots (a power of 2, larger than the biggest priority step) */
+#define RQ_SLOTS		64
+#define RQ_MASK			(RQ_SLOTS - 1)
+
+/* initial size of the task id table (doubled when full) */
+#define TASK_IDS		16
+
+/* longest tickless idle sleep, in ticks (the HAL may sleep less) */
+#define TICKLESS_MAX		0xffff
+
+/* harts (cpus) running tasks, set by the architecture for SMP builds */
+#ifndef NCPU
+#define NCPU			1
+#endif
+
+/* task affinity mask with all harts */
+#define CPU_MASK_ALL		(0xffffffff >> (32 - NCPU))
+
 /* task control block node */
 struct tcb_s {
 	void (*task)(void);
@@ -15,29 +33,128 @@ struct tcb_s {
 	size_t *stack;
 	size_t stack_sz;
 	uint16_t id;
-	uint16_t delay;
+	uint16_t delay;			/* ticks, relative to the previous delayed task */
+	uint16_t priority;
+	uint16_t base_priority;		/* priority, not inherited from a mutex waiter */
+	uint8_t state;
+	uint8_t cpu;			/* hart the task runs, ran or is queued on */
+	uint8_t rq_slot;		/* ready queue slot (when READY) */
+	uint32_t affinity;		/* harts the task may run on (bitmask) */
+	struct tcb_s *rq_next;		/* ready queue links */
+	struct tcb_s *rq_prev;
+	struct ilist_s delay_link;	/* delay list link */
+	struct ilist_s wq_link;		/* wait queue link */
+	struct ilist_s link;		/* task list link */
+	struct ilist_s mutexes;		/* mutexes held with waiters */
+	struct mutex_s *mutex_wait;	/* mutex the task is waiting for */
+	uint16_t mutex_held;		/* mutexes held (not counting recursive locks) */
+	struct sem_s *sem_wait;		/* semaphore the task is waiting on */
+	uint64_t run_time;		/* time running, in us */
+	uint64_t run_mark;		/* run time at the last ucx_task_top() */
+	uint32_t switches;		/* voluntary context switches */
+	uint32_t preemptions;		/* involuntary context switches */
+	uint16_t rt_period;		/* real time task period, in ticks (0: best effort) */
+	uint16_t rt_capacity;		/* execution time per period, in ticks */
+	uint16_t rt_deadline;		/* deadline, in ticks after each release */
+	uint16_t rt_budget;		/* capacity left for the current job */
+	uint32_t rt_release;		/* current job release time, in ticks */
+	uint32_t rt_due;		/* current job absolute deadline, in ticks */
+	uint32_t rt_misses;		/* deadlines missed */
+	struct ilist_s rt_link;		/* real time queue link */
+	uint16_t period;		/* periodic task period, in ticks (0: not periodic) */
+	uint32_t wake;			/* periodic task last wakeup time, in ticks */
+};
+
+/* task statistics */
+struct task_stats_s {
+	uint64_t run_time;		/* us */
+	uint32_t switches;
+	uint32_t preemptions;
+	uint32_t misses;		/* deadlines missed (real time tasks) */
+	uint16_t id;
 	uint16_t priority;
 	uint8_t state;
+	uint8_t cpu;
+};
+
+/* per hart kernel state */
+struct cpu_s {
+	struct tcb_s *task_current;
+	struct tcb_s *idle;		/* kernel idle task (TICKLESS or SMP) */
+	struct tcb_s *rq[RQ_SLOTS];	/* ready queues, one per slot */
+	uint32_t rq_map[RQ_SLOTS / 32];	/* non empty ready queues bitmap */
+	uint16_t rq_count;		/* ready tasks */
+	uint8_t rq_time;		/* current ready queue slot */
+	uint64_t run_start;		/* current task run time start, in us */
+	uint8_t in_tick;		/* scheduler called from the tick */
+	uint8_t irq_on;			/* interrupts were enabled when the kernel lock was taken (SMP) */
 };
 
 /* kernel control block */
 struct kcb_s {
-	struct list_s *tasks;
-	struct node_s *task_current;
+	struct ilist_s tasks;
+	struct tcb_s **task_ids;	/* tasks, indexed by id */
+	uint16_t task_ids_max;
+	struct cpu_s cpu[NCPU];
+	volatile uint32_t lock;		/* kernel lock (SMP) */
 	jmp_buf context;
 	struct queue_s *events;
+	struct ilist_s delay_list;	/* delayed tasks, sorted by wakeup time */
+	struct ilist_s rt_queue;	/* ready real time tasks, sorted by deadline */
+	uint16_t rt_load;		/* admitted real time load, per 1000 */
 	volatile uint32_t ticks;
-	uint16_t id_next;
+	volatile uint32_t ticks_hi;	/* tick count wraps, the high word of the 64 bit count */
+	uint64_t top_time;		/* time of the last ucx_task_top() */
+	uint16_t task_count;
+	uint16_t id_next;		/* lowest id that may be free */
 	char preemptive;
 };
 
 extern struct kcb_s *kcb;
 
+/*
+ * With more than one hart (SMP), all kernel state is protected by a single
+ * spinlock, taken by critical sections and by the tick. Interrupts are always
+ * disabled on the hart that holds it, also in cooperative mode, otherwise an
+ * interrupt handler that takes the lock (the UART) would spin forever on it.
+ * In cooperative mode, leaving a critical section restores the interrupt
+ * state it was entered with. The HAL provides the hart id, and a way
+ * to interrupt another hart (an IPI), used to wake up an idle hart when a
+ * task becomes ready. Each hart has its own current and idle tasks.
+ */
+#if NCPU > 1
+#define krnl_cpu_id()		_cpu_id()
+#define krnl_lock()		({ while (__atomic_exchange_n(&kcb->lock, 1, __ATOMIC_ACQUIRE)); })
+#define krnl_unlock()		__atomic_store_n(&kcb->lock, 0, __ATOMIC_RELEASE)
+#else
+#define krnl_cpu_id()		0
+#define krnl_lock()
+#define krnl_unlock()
+#endif
+#define krnl_cpu()		(&kcb->cpu[krnl_cpu_id()])
+
 /* kernel API */
+#if NCPU > 1
+#define CRITICAL_ENTER()({int32_t s = _di(); krnl_lock(); krnl_cpu()->irq_on = s != 0; })
+#define CRITICAL_LEAVE()({int32_t s = kcb->preemptive == 'y' || krnl_cpu()->irq_on; krnl_unlock(); if (s) _ei(); })
+#else
 #define CRITICAL_ENTER()({kcb->preemptive == 'y' ? _di() : 0; })
 #define CRITICAL_LEAVE()({kcb->preemptive == 'y' ? _ei() : 0; })
+#endif
+
+struct tcb_s *krnl_current(void);
 
 void krnl_panic(uint32_t ecode);
+void krnl_setstate(struct tcb_s *task, uint8_t state);
+void krnl_setnext(struct tcb_s *task);
+void krnl_setprio(struct tcb_s *task, uint16_t priority);
+void krnl_delay_update(uint32_t ticks);
+void krnl_tick(uint32_t ticks);
+void krnl_idle_init(void);
+void krnl_yield(void);
+int32_t krnl_wq_wait(struct ilist_s *wq, uint16_t ticks);
+void krnl_wq_wakeup(struct ilist_s *wq);
+struct tcb_s *krnl_wq_wakeone(struct ilist_s *wq);
 uint16_t krnl_schedule(void);
 void krnl_dispatcher(void);
 /* actual dispatch/yield implementation may be platform dependent */
@@ -46,15 +163,27 @@ void _yield(void);
 
 /* task management API */
 int32_t ucx_task_add(void *task, uint16_t stack_size);
+int32_t ucx_task_rt_add(void *task, uint16_t stack_size, uint16_t period,
+	uint16_t capacity, uint16_t deadline);
+void ucx_task_rt_wait(void);
 int32_t ucx_task_remove(uint16_t id);
 void ucx_task_yield();
 void ucx_task_delay(uint16_t ticks);
+int32_t ucx_task_delay_until(uint32_t *last_wake, uint16_t period);
+int32_t ucx_task_period(uint16_t id, uint16_t period);
+void ucx_task_wait_period(void);
 int32_t ucx_task_suspend(uint16_t id);
 int32_t ucx_task_resume(uint16_t id);
 int32_t ucx_task_priority(uint16_t id, uint16_t priority);
+int32_t ucx_task_affinity(uint16_t id, uint32_t mask);
 uint16_t ucx_task_id();
 void ucx_task_wfi();
 uint16_t ucx_task_count();
+int32_t ucx_task_stats(uint16_t id, struct task_stats_s *stats);
+void ucx_task_top(void);
+int32_t ucx_task_stack_usage(uint16_t id);
+void ucx_task_stack_report(void);
 uint32_t ucx_ticks();
+uint64_t ucx_ticks64(void);
 
 int32_t app_main();
@@ -0,0 +1,28 @@
+/* deferred log ring buffer size, in 32 bit words (a power of 2) */
+#ifndef LOG_SIZE
+#define LOG_SIZE		256
+#endif
+
+/* task id of records logged before the scheduler is started */
+#define LOG_NO_TASK		0xffff
+
+/*
+ * deferred logging: only the format string address and the arguments are
+ * recorded, and the text is formatted on the host (tools/logdec.py). format
+ * strings must be literals, arguments are integers (pointers must be cast to
+ * size_t) and %s arguments are decoded only if they point to constant data.
+ * use ucx_log() in tasks and ucx_log_isr() in interrupt handlers.
+ */
+#define ucx_log(fmt, ...)	({ \
+	uint32_t log_args[] = {0, ##__VA_ARGS__}; \
+	ucx_log_put(fmt, log_args + 1, sizeof(log_args) / sizeof(uint32_t) - 1); \
+})
+
+#define ucx_log_isr(fmt, ...)	({ \
+	uint32_t log_args[] = {0, ##__VA_ARGS__}; \
+	ucx_log_put_isr(fmt, log_args + 1, sizeof(log_args) / sizeof(uint32_t) - 1); \
+})
+
+int32_t ucx_log_put(const char *fmt, const uint32_t *args, uint16_t n);
+int32_t ucx_log_put_isr(const char *fmt, const uint32_t *args, uint16_t n);
+int32_t ucx_log_flush(void);
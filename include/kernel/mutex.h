@@ -0,0 +1,12 @@
+struct mutex_s {
+	struct ilist_s waiters;		/* wait queue */
+	struct ilist_s link;		/* owner's held mutexes list link */
+	struct tcb_s *volatile owner;
+	uint16_t depth;			/* recursive locks by the owner */
+};
+
+struct mutex_s *ucx_mutex_create(void);
+int32_t ucx_mutex_destroy(struct mutex_s *m);
+int32_t ucx_mutex_lock(struct mutex_s *m);
+int32_t ucx_mutex_trylock(struct mutex_s *m);
+int32_t ucx_mutex_unlock(struct mutex_s *m);
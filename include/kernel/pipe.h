@@ -1,12 +1,25 @@
+/* pipe transfer timeouts (ticks) */
+#define PIPE_NOWAIT		0
+#define PIPE_FOREVER		-1
+
 struct pipe_s {
 	char *data;
 	uint32_t mask;				/* size must be a power of 2 */
-	int32_t head, tail, size;
+	volatile uint32_t head;			/* written by the consumer only */
+	volatile uint32_t tail;			/* written by the producer only */
+	uint8_t spsc;				/* single producer / consumer, lock free */
+	struct ilist_s readers;			/* tasks waiting for data */
+	struct ilist_s writers;			/* tasks waiting for space */
 };
 
 struct pipe_s *ucx_pipe_create(uint16_t size);
+struct pipe_s *ucx_pipe_create_spsc(uint16_t size);
 int32_t ucx_pipe_destroy(struct pipe_s *pipe);
 void ucx_pipe_flush(struct pipe_s *pipe);
 int32_t ucx_pipe_size(struct pipe_s *pipe);
 int32_t ucx_pipe_read(struct pipe_s *pipe, char *data, uint16_t size);
 int32_t ucx_pipe_write(struct pipe_s *pipe, char *data, uint16_t size);
+int32_t ucx_pipe_tryread(struct pipe_s *pipe, char *data, uint16_t size);
+int32_t ucx_pipe_trywrite(struct pipe_s *pipe, char *data, uint16_t size);
+int32_t ucx_pipe_read_timeout(struct pipe_s *pipe, char *data, uint16_t size, uint16_t ticks);
+int32_t ucx_pipe_write_timeout(struct pipe_s *pipe, char *data, uint16_t size, uint16_t ticks);
@@ -1,5 +1,5 @@
 struct sem_s {
-	struct queue_s *sem_queue;
+	struct ilist_s waiters;		/* wait queue */
 	volatile int32_t count;
 };
 
@@ -7,3 +7,4 @@ struct sem_s *ucx_sem_create(uint16_t max_tasks, int32_t value);
 int32_t ucx_sem_destroy(struct sem_s *s);
 void ucx_sem_wait(struct sem_s *s);
 void ucx_sem_signal(struct sem_s *s);
+void ucx_sem_signal_preempt(struct sem_s *s);
@@ -0,0 +1,27 @@
+/* timer wheel slots (a power of 2) */
+#define TIMER_WHEEL		32
+#define TIMER_MASK		(TIMER_WHEEL - 1)
+
+/* timer flags */
+#define TIMER_ONESHOT		0x00
+#define TIMER_AUTORELOAD	0x01		/* restart the timer when it expires */
+#define TIMER_ISR		0x02		/* run the callback from the tick */
+
+struct timer_s {
+	struct ilist_s link;		/* timer wheel slot link */
+	struct ilist_s run_link;	/* expired timers link (timer task) */
+	void (*callback)(void *);
+	void *arg;
+	uint32_t expire;		/* expiration time, in ticks */
+	uint16_t period;		/* ticks */
+	uint8_t flags;
+};
+
+void krnl_timer_init(void);
+void krnl_timer_update(uint32_t ticks);
+uint32_t krnl_timer_next(void);
+
+struct timer_s *ucx_timer_create(void (*callback)(void *), void *arg, uint16_t period, uint8_t flags);
+int32_t ucx_timer_destroy(struct timer_s *timer);
+int32_t ucx_timer_start(struct timer_s *timer);
+int32_t ucx_timer_stop(struct timer_s *timer);
@@ -0,0 +1,30 @@
+/* kernel event trace ring buffer size, in records (a power of 2) */
+#ifndef TRACE_SIZE
+#define TRACE_SIZE		128
+#endif
+
+/* trace events */
+#define TRACE_SWITCH_IN		1		/* arg: task priority */
+#define TRACE_SWITCH_OUT	2		/* arg: task state */
+#define TRACE_SEM_WAIT		3		/* arg: semaphore */
+#define TRACE_SEM_SIGNAL	4		/* arg: semaphore */
+#define TRACE_PIPE_BLOCK	5		/* arg: pipe */
+#define TRACE_PIPE_UNBLOCK	6		/* arg: pipe */
+#define TRACE_MALLOC		7		/* arg: size */
+#define TRACE_FREE		8		/* arg: pointer */
+#define TRACE_ISR_ENTER		9		/* arg: irq (0 is the tick) */
+#define TRACE_ISR_EXIT		10		/* arg: irq */
+
+/*
+ * kernel event tracing is enabled at compile time (-DTRACE). trace points
+ * are placed where interrupts are already disabled (inside critical sections
+ * and interrupt handlers), and compile to nothing otherwise.
+ */
+#ifdef TRACE
+#define krnl_trace(event, arg)	krnl_trace_put(event, (size_t)(arg))
+#else
+#define krnl_trace(event, arg)
+#endif
+
+void krnl_trace_put(uint8_t event, uint32_t arg);
+int32_t ucx_trace_dump(void);
@@ -1,4 +1,5 @@
 #include <hal.h>
+#include <stdarg.h>
 
 #define NULL			((void *)0)
 #define USED			1
@@ -69,5 +70,7 @@ char *ucx_fgets(char *s, int n, void *f);
 char *ucx_getline(char *s);
 int32_t ucx_printf(const char *fmt, ...);
 int32_t ucx_sprintf(char *out, const char *fmt, ...);
+int32_t ucx_snprintf(char *out, size_t size, const char *fmt, ...);
+int32_t ucx_vsnprintf(char *out, size_t size, const char *fmt, va_list args);
 
 
@@ -42,3 +42,24 @@ struct dnode_s *dlist_insert(struct dlist_s *list, struct dnode_s *prevnode, voi
 struct dnode_s *dlist_remove(struct dlist_s *list, struct dnode_s *node);
 struct dnode_s *dlist_index(struct dlist_s *list, int idx);
 struct dnode_s *dlist_foreach(struct dlist_s *list, struct dnode_s *(*iter_fn)(struct dnode_s *, void *), void *arg);
+
+/*
+ * intrusive doubly linked list. links are embedded in the listed objects, so
+ * no memory is allocated and insertion and removal take constant time. lists
+ * are circular, with the list head as a sentinel, and a link that is not on
+ * any list points to itself.
+ */
+struct ilist_s {
+	struct ilist_s *next;
+	struct ilist_s *prev;
+};
+
+#define ilist_entry(link, type, member)	((type *)((char *)(link) - (size_t)&((type *)0)->member))
+#define ilist_empty(list)		((list)->next == (list))
+#define ilist_linked(link)		((link)->next != (link))
+
+void ilist_init(struct ilist_s *list);
+void ilist_push(struct ilist_s *list, struct ilist_s *link);
+void ilist_pushback(struct ilist_s *list, struct ilist_s *link);
+void ilist_remove(struct ilist_s *link);
+struct ilist_s *ilist_pop(struct ilist_s *list);
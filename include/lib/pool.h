@@ -0,0 +1,27 @@
+/* objects per chunk of the kernel object pools */
+#define TCB_POOL_SIZE		4
+#define NODE_POOL_SIZE		16
+#define QUEUE_POOL_SIZE		4
+#define SEM_POOL_SIZE		8
+#define MUTEX_POOL_SIZE		8
+#define EQ_POOL_SIZE		4
+#define TIMER_POOL_SIZE		8
+
+struct pool_chunk_s {
+	struct pool_chunk_s *next;
+	size_t pad;				/* keeps objects aligned */
+};
+
+struct pool_s {
+	void *free;				/* free objects list */
+	struct pool_chunk_s *chunks;		/* memory chunks, allocated from the heap */
+	uint32_t obj_size;
+	uint16_t count;				/* objects per chunk */
+	uint16_t used;
+};
+
+struct pool_s *ucx_pool_create(uint32_t obj_size, uint16_t count);
+struct pool_s *ucx_pool_get(struct pool_s **pool, uint32_t obj_size, uint16_t count);
+int32_t ucx_pool_destroy(struct pool_s *pool);
+void *ucx_pool_alloc(struct pool_s *pool);
+void ucx_pool_free(struct pool_s *pool, void *obj);
@@ -4,9 +4,15 @@
 #include <lib/list.h>
 #include <lib/queue.h>
 #include <lib/malloc.h>
+#include <lib/pool.h>
 #include <kernel/pipe.h>
 #include <kernel/semaphore.h>
+#include <kernel/mutex.h>
 #include <kernel/event.h>
+#include <kernel/timer.h>
+#include <kernel/console.h>
+#include <kernel/log.h>
+#include <kernel/trace.h>
 #include <kernel/kernel.h>
 #include <kernel/errno.h>
 #include <kernel/stat.h>
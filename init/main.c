@@ -10,6 +10,7 @@
 
 int32_t main(void)
 {
+	struct cpu_s *cpu = krnl_cpu();
 	struct tcb_s *task;
 	int32_t pr;
 	
@@ -23,15 +24,16 @@ int32_t main(void)
 	ucx_heap_init((size_t *)&__bss_end, ((size_t)&__stack - (size_t)&__bss_end - DEFAULT_STACK_SIZE));
 	printf("heap_init(), %d bytes free\n", ((size_t)&__stack - (size_t)&__bss_end - DEFAULT_STACK_SIZE));
 #endif
-	kcb->tasks = list_create();
-	
-	if (!kcb->tasks)
-		krnl_panic(ERR_KCB_ALLOC);
+	ilist_init(&kcb->tasks);
+	ilist_init(&kcb->delay_list);
+	ilist_init(&kcb->rt_queue);
+	krnl_timer_init();
 
 	pr = app_main();
+	krnl_idle_init();
 	setjmp(kcb->context);
 	
-	if (!kcb->tasks->length)
+	if (!kcb->task_count)
 		krnl_panic(ERR_NO_TASKS);
 
 	if (pr) {
@@ -41,10 +43,48 @@ int32_t main(void)
 		kcb->preemptive = 'n';
 	}
 
-	kcb->task_current = kcb->tasks->head->next;
-	task = kcb->task_current->data;
+#if NCPU > 1
+	/* the first task to run leaves this critical section */
+	CRITICAL_ENTER();
+#endif
+	cpu->task_current = ilist_entry(kcb->tasks.next, struct tcb_s, link);
+	cpu->run_start = _read_us();
+	kcb->top_time = cpu->run_start;
+	krnl_schedule();
+#if NCPU > 1
+	_cpu_start();
+#endif
+	task = cpu->task_current;
 	_dispatch_init(task->context);
 	
 	/* never reached */
 	return 0;
 }
+
+#if NCPU > 1
+/*
+ * entry point of the other harts (SMP), called from the C runtime once hart
+ * 0 has started the kernel. each hart starts on its idle task and schedules
+ * the first ready task. harts beyond NCPU are kept asleep.
+ */
+void main_cpu(void)
+{
+	struct cpu_s *cpu;
+	struct tcb_s *task;
+
+	if (krnl_cpu_id() >= NCPU)
+		for (;;)
+			_cpu_idle();
+
+	if (kcb->preemptive == 'y')
+		_timer_enable();
+
+	CRITICAL_ENTER();
+	cpu = krnl_cpu();
+	cpu->task_current = cpu->idle;
+	cpu->run_start = _read_us();
+	krnl_schedule();
+	task = cpu->task_current;
+	_dispatch_init(task->context);
+}
+#endif
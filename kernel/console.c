@@ -0,0 +1,68 @@
+/* file:          console.c
+ * description:   buffered console output
+ * date:          10/2026
+ * author:        Sergio Johann Filho <sergio.johann@acad.pucrs.br>
+ */
+
+#include <ucx.h>
+
+/*
+ * On ports built with CONSOLE_IRQ, _putchar() queues characters in a ring
+ * buffer with krnl_console_putc(), and the UART transmitter interrupt takes
+ * them out with krnl_console_getc(). A task printing to a full buffer sleeps
+ * on a wait queue until the interrupt handler has sent half of it, so other
+ * tasks run while the UART is busy. This needs the kernel idle task (TICKLESS
+ * or SMP builds), as all tasks may be waiting. Otherwise (no idle task, from the
+ * idle task or in cooperative mode) the caller waits for space with
+ * interrupts enabled. With interrupts disabled, the port drains the buffer
+ * with krnl_console_getc() and sends characters by polling, so output from
+ * interrupt handlers and krnl_panic() keeps its order.
+ */
+
+#ifdef CONSOLE_IRQ
+static struct {
+	char buf[CONSOLE_BUF_SIZE];
+	volatile uint16_t head, tail;		/* free running indexes */
+	struct ilist_s waiters;
+} console = {
+	.waiters = {&console.waiters, &console.waiters}
+};
+
+void krnl_console_putc(char c)
+{
+	struct cpu_s *cpu;
+
+	CRITICAL_ENTER();
+	while ((uint16_t)(console.head - console.tail) == CONSOLE_BUF_SIZE) {
+		cpu = krnl_cpu();
+		if (kcb->preemptive == 'y' && cpu->idle && cpu->task_current != cpu->idle) {
+			krnl_wq_wait(&console.waiters, 0);
+		} else {
+			CRITICAL_LEAVE();
+			CRITICAL_ENTER();
+		}
+	}
+	console.buf[console.head & (CONSOLE_BUF_SIZE - 1)] = c;
+	console.head++;
+	_console_tx_start();
+	CRITICAL_LEAVE();
+}
+
+/* called from the UART interrupt handler, or with interrupts disabled */
+int32_t krnl_console_getc(void)
+{
+	char c;
+
+	if (console.head == console.tail)
+		return -1;
+
+	c = console.buf[console.tail & (CONSOLE_BUF_SIZE - 1)];
+	console.tail++;
+
+	if (!ilist_empty(&console.waiters) &&
+	    (uint16_t)(console.head - console.tail) <= CONSOLE_BUF_SIZE / 2)
+		krnl_wq_wakeup(&console.waiters);
+
+	return (unsigned char)c;
+}
+#endif
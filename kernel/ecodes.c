@@ -17,6 +17,9 @@ struct ecode_s edatadesc[] = {
 	{ERR_SEM_ALLOC,			"sema alloc failed"},
 	{ERR_SEM_DEALLOC,		"sema dealloc failed"},
 	{ERR_EQ_NOTEMPTY,		"message queue not empty"},
+	{ERR_TIMEOUT,			"timeout"},
+	{ERR_MUTEX_OWNER,		"mutex not owned"},
+	{ERR_TASK_RT_LOAD,		"real time load exceeded"},
 	{ERR_UNKNOWN,			"unknown reason"}
 };
 
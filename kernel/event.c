@@ -6,11 +6,14 @@
 
 #include <ucx.h>
 
+static struct pool_s *eq_pool;
+
 struct eq_s *ucx_eq_create(uint16_t events)
 {
 	struct eq_s *eqptr;
 	
-	eqptr = malloc(sizeof(struct eq_s));
+	eqptr = ucx_pool_get(&eq_pool, sizeof(struct eq_s), EQ_POOL_SIZE) ?
+		ucx_pool_alloc(eq_pool) : 0;
 	
 	if (!eqptr)
 		return 0;
@@ -18,7 +21,7 @@ struct eq_s *ucx_eq_create(uint16_t events)
 	eqptr->event_queue = queue_create(events);
 	
 	if (!eqptr->event_queue) {
-		free(eqptr);
+		ucx_pool_free(eq_pool, eqptr);
 		return 0;
 	}
 	
@@ -26,7 +29,7 @@ struct eq_s *ucx_eq_create(uint16_t events)
 	
 	if (!eqptr->mutex) {
 		queue_destroy(eqptr->event_queue);
-		free(eqptr);
+		ucx_pool_free(eq_pool, eqptr);
 		return 0;
 	}
 	
@@ -48,7 +51,7 @@ int32_t ucx_eq_destroy(struct eq_s *eq)
 	if (ucx_sem_destroy(eq->mutex))
 		return ERR_SEM_DEALLOC;
 		
-	free(eq);
+	ucx_pool_free(eq_pool, eq);
 	
 	return 0;
 }
@@ -0,0 +1,185 @@
+/* file:          log.c
+ * description:   deferred (binary) logging
+ * date:          10/2026
+ * author:        Sergio Johann Filho <sergio.johann@acad.pucrs.br>
+ */
+
+#include <ucx.h>
+
+/*
+ * Log records are written to a ring buffer of 32 bit words, as:
+ *
+ *   LOG_COMMIT | task id << 8 | n | ticks | fmt | arg 0 | ... | arg n - 1
+ *
+ * where the format string address takes LOG_FMT_WORDS words (two on 64 bit
+ * hosts, low word first). A writer reserves space by moving the head index,
+ * fills the record and stores the first word last, with release ordering,
+ * which commits it (the reader loads it with acquire ordering, so the rest
+ * of the record is seen, also from another hart). The head is moved
+ * with a compare and swap where the architecture has one (LOG_CAS), else
+ * with interrupts masked for a few instructions. The reader (ucx_log_flush()) takes
+ * committed records from the tail, in order, and clears the words it has
+ * consumed, so a zero in the first word means the record is still being
+ * written. When the buffer is full, new records are dropped and counted.
+ *
+ * Records are sent to the console as lines of hex words, prefixed by '#L',
+ * and decoded back into text by tools/logdec.py, which looks up the format
+ * strings in the ELF image. Formatting text on the target (and the software
+ * divisions it takes on some architectures) is left to the host.
+ */
+
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_2) && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+#define LOG_CAS
+#endif
+
+#define LOG_COMMIT		0x80000000
+#define LOG_FMT_WORDS		((sizeof(size_t) + 3) / 4)
+#define LOG_HDR_WORDS		(2 + LOG_FMT_WORDS)
+
+static struct {
+	volatile uint32_t buf[LOG_SIZE];
+	volatile uint16_t head, tail;		/* free running indexes */
+	uint32_t dropped;
+} ring;
+
+static int32_t log_reserve(uint16_t len)
+{
+	uint16_t pos;
+
+#ifdef LOG_CAS
+	pos = ring.head;
+	do {
+		/* the words before the tail have been cleared by the reader */
+		if ((uint16_t)(LOG_SIZE - (uint16_t)(pos - __atomic_load_n(&ring.tail, __ATOMIC_ACQUIRE))) < len) {
+			__atomic_fetch_add(&ring.dropped, 1, __ATOMIC_RELAXED);
+
+			return -1;
+		}
+	} while (!__atomic_compare_exchange_n(&ring.head, &pos, pos + len, 1,
+		__ATOMIC_RELAXED, __ATOMIC_RELAXED));
+#else
+	if ((uint16_t)(LOG_SIZE - (uint16_t)(ring.head - ring.tail)) < len) {
+		ring.dropped++;
+
+		return -1;
+	}
+	pos = ring.head;
+	ring.head = pos + len;
+#endif
+
+	return pos;
+}
+
+static void log_write(uint16_t pos, const char *fmt, const uint32_t *args, uint16_t n)
+{
+	struct tcb_s *task = krnl_current();
+	uint64_t addr = (size_t)fmt;
+	uint16_t i;
+
+	ring.buf[(pos + 1) & (LOG_SIZE - 1)] = kcb->ticks;
+	for (i = 0; i < LOG_FMT_WORDS; i++)
+		ring.buf[(pos + 2 + i) & (LOG_SIZE - 1)] = addr >> (i * 32);
+	for (i = 0; i < n; i++)
+		ring.buf[(pos + LOG_HDR_WORDS + i) & (LOG_SIZE - 1)] = args[i];
+	__atomic_store_n(&ring.buf[pos & (LOG_SIZE - 1)], LOG_COMMIT |
+		((uint32_t)(task ? task->id : LOG_NO_TASK) << 8) | n, __ATOMIC_RELEASE);
+}
+
+int32_t ucx_log_put(const char *fmt, const uint32_t *args, uint16_t n)
+{
+	int32_t pos;
+
+	if (n > 255)
+		return ERR_FAIL;
+
+#ifdef LOG_CAS
+	pos = log_reserve(n + LOG_HDR_WORDS);
+#else
+	CRITICAL_ENTER();
+	pos = log_reserve(n + LOG_HDR_WORDS);
+	CRITICAL_LEAVE();
+#endif
+
+	if (pos < 0)
+		return ERR_FAIL;
+	log_write(pos, fmt, args, n);
+
+	return ERR_OK;
+}
+
+/* interrupt handlers run with interrupts disabled, no need to mask them */
+int32_t ucx_log_put_isr(const char *fmt, const uint32_t *args, uint16_t n)
+{
+	int32_t pos;
+
+	if (n > 255)
+		return ERR_FAIL;
+
+	pos = log_reserve(n + LOG_HDR_WORDS);
+	if (pos < 0)
+		return ERR_FAIL;
+	log_write(pos, fmt, args, n);
+
+	return ERR_OK;
+}
+
+static void log_hex(uint32_t val)
+{
+	int8_t i;
+	char c;
+
+	_putchar(' ');
+	for (i = 28; i >= 0; i -= 4) {
+		c = (val >> i) & 0xf;
+		_putchar(c > 9 ? c + 'a' - 10 : c + '0');
+	}
+}
+
+/*
+ * sends the committed records to the console (and the number of records
+ * dropped, if any), and returns how many were sent. meant to be called by a
+ * low priority task.
+ */
+int32_t ucx_log_flush(void)
+{
+	uint16_t tail, len, i;
+	uint32_t dropped, hdr;
+	int32_t count = 0;
+
+#ifdef LOG_CAS
+	dropped = __atomic_exchange_n(&ring.dropped, 0, __ATOMIC_RELAXED);
+#else
+	CRITICAL_ENTER();
+	dropped = ring.dropped;
+	ring.dropped = 0;
+	CRITICAL_LEAVE();
+#endif
+	tail = ring.tail;
+
+	if (dropped) {
+		_putchar('#');
+		_putchar('D');
+		log_hex(dropped);
+		_putchar('\n');
+	}
+
+	while ((hdr = __atomic_load_n(&ring.buf[tail & (LOG_SIZE - 1)], __ATOMIC_ACQUIRE))) {
+		len = (hdr & 0xff) + LOG_HDR_WORDS;
+		_putchar('#');
+		_putchar('L');
+		for (i = 0; i < len; i++) {
+			log_hex(ring.buf[(tail + i) & (LOG_SIZE - 1)]);
+			ring.buf[(tail + i) & (LOG_SIZE - 1)] = 0;
+		}
+		_putchar('\n');
+		tail += len;
+		count++;
+
+		/* 16 bit stores are not atomic on 8 bit architectures */
+		CRITICAL_ENTER();
+		ring.tail = tail;
+		CRITICAL_LEAVE();
+	}
+
+	return count;
+}
@@ -0,0 +1,237 @@
+/* file:          mutex.c
+ * description:   mutexes with priority inheritance
+ * date:          10/2026
+ * author:        Sergio Johann Filho <sergio.johann@acad.pucrs.br>
+ */
+
+#include <ucx.h>
+
+/*
+ * A mutex is owned by the task that locked it, which may lock it again
+ * (recursively) and must unlock it as many times. Locking a free mutex only
+ * sets the owner, with a compare and swap where the architecture has one
+ * (MUTEX_CAS), and no wait queue is touched. Each task counts the mutexes it
+ * holds, so a task that holds one is not removed.
+ *
+ * A task finding the mutex taken sleeps on its wait queue, and lends its
+ * priority to the owner if it is higher, so the owner is moved closer in the
+ * ready queues. The boost is carried along a chain of owners waiting for other
+ * mutexes. Mutexes with waiters are linked to their owner, and on unlock the
+ * mutex is handed to the highest priority waiter, while the former owner goes
+ * back to its base priority (or to the highest priority among the waiters of
+ * the mutexes it still holds). If the new owner has a higher priority than
+ * the former one, it runs right away.
+ *
+ * Mutexes must not be used in interrupt handlers.
+ */
+
+#if __SIZEOF_POINTER__ == 4 && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+#define MUTEX_CAS
+#elif __SIZEOF_POINTER__ == 8 && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8)
+#define MUTEX_CAS
+#endif
+
+static struct pool_s *mutex_pool;
+
+struct mutex_s *ucx_mutex_create(void)
+{
+	struct mutex_s *m;
+
+	m = ucx_pool_get(&mutex_pool, sizeof(struct mutex_s), MUTEX_POOL_SIZE) ?
+		ucx_pool_alloc(mutex_pool) : 0;
+
+	if (!m)
+		return 0;
+
+	ilist_init(&m->waiters);
+	ilist_init(&m->link);
+	m->owner = 0;
+	m->depth = 0;
+
+	return m;
+}
+
+int32_t ucx_mutex_destroy(struct mutex_s *m)
+{
+	if (m->owner || !ilist_empty(&m->waiters))
+		return ERR_FAIL;
+
+	ucx_pool_free(mutex_pool, m);
+
+	return ERR_OK;
+}
+
+/*
+ * sets the owner of a mutex if it is free. without MUTEX_CAS, must be called
+ * inside a critical section. with it, the mutex may be taken on another hart
+ * (by mutex_take()) even while the kernel lock is held.
+ */
+static int32_t mutex_set(struct mutex_s *m, struct tcb_s *task)
+{
+#ifdef MUTEX_CAS
+	struct tcb_s *free = 0;
+
+	return __atomic_compare_exchange_n(&m->owner, &free, task, 0,
+		__ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+#else
+	if (m->owner)
+		return 0;
+	m->owner = task;
+
+	return 1;
+#endif
+}
+
+/* takes a free mutex (the held count is only changed by its task, or when it waits) */
+static int32_t mutex_take(struct mutex_s *m, struct tcb_s *task)
+{
+	int32_t taken;
+
+#ifdef MUTEX_CAS
+	taken = mutex_set(m, task);
+#else
+	CRITICAL_ENTER();
+	taken = mutex_set(m, task);
+	CRITICAL_LEAVE();
+#endif
+	if (taken)
+		task->mutex_held++;
+
+	return taken;
+}
+
+/* lends a priority to the owner of a mutex, and to the owners it waits for */
+static void mutex_boost(struct mutex_s *m, uint16_t priority)
+{
+	struct tcb_s *owner;
+
+	while (m && (owner = m->owner) && (priority & 0xff) < (owner->priority & 0xff)) {
+		krnl_setprio(owner, priority);
+		m = owner->mutex_wait;
+	}
+}
+
+/* priority of a task, given the waiters of the mutexes it holds */
+static uint16_t mutex_priority(struct tcb_s *task)
+{
+	struct ilist_s *l, *w;
+	struct mutex_s *m;
+	struct tcb_s *waiter;
+	uint16_t priority = task->base_priority;
+
+	for (l = task->mutexes.next; l != &task->mutexes; l = l->next) {
+		m = ilist_entry(l, struct mutex_s, link);
+		for (w = m->waiters.next; w != &m->waiters; w = w->next) {
+			waiter = ilist_entry(w, struct tcb_s, wq_link);
+			if ((waiter->priority & 0xff) < (priority & 0xff))
+				priority = waiter->priority;
+		}
+	}
+
+	return priority;
+}
+
+int32_t ucx_mutex_lock(struct mutex_s *m)
+{
+	struct tcb_s *task = krnl_current();
+
+	if (m->owner == task) {
+		m->depth++;
+
+		return ERR_OK;
+	}
+
+	if (mutex_take(m, task)) {
+		m->depth = 1;
+
+		return ERR_OK;
+	}
+
+	/*
+	 * the mutex may have been unlocked since, or be taken on another hart
+	 * right now, so it is taken with a compare and swap here too. once it has
+	 * an owner, it can't be unlocked while the kernel lock is held.
+	 */
+	CRITICAL_ENTER();
+	if (mutex_set(m, task)) {
+		task->mutex_held++;
+	} else {
+		if (!ilist_linked(&m->link))
+			ilist_pushback(&m->owner->mutexes, &m->link);
+		task->mutex_wait = m;
+		mutex_boost(m, task->priority);
+		/* ucx_mutex_unlock() hands the mutex over before waking us up */
+		krnl_wq_wait(&m->waiters, 0);
+		task->mutex_wait = 0;
+	}
+	m->depth = 1;
+	CRITICAL_LEAVE();
+
+	return ERR_OK;
+}
+
+int32_t ucx_mutex_trylock(struct mutex_s *m)
+{
+	struct tcb_s *task = krnl_current();
+
+	if (m->owner == task) {
+		m->depth++;
+
+		return ERR_OK;
+	}
+
+	if (!mutex_take(m, task))
+		return ERR_FAIL;
+	m->depth = 1;
+
+	return ERR_OK;
+}
+
+int32_t ucx_mutex_unlock(struct mutex_s *m)
+{
+	struct tcb_s *task = krnl_current(), *next = 0, *waiter;
+	struct ilist_s *l;
+	int32_t preempt = 0;
+
+	if (m->owner != task)
+		return ERR_MUTEX_OWNER;
+
+	if (--m->depth)
+		return ERR_OK;
+
+	CRITICAL_ENTER();
+	task->mutex_held--;
+	if (ilist_empty(&m->waiters)) {
+		__atomic_store_n(&m->owner, 0, __ATOMIC_RELEASE);
+		CRITICAL_LEAVE();
+
+		return ERR_OK;
+	}
+
+	/* hand the mutex to the highest priority (and oldest) waiter */
+	for (l = m->waiters.next; l != &m->waiters; l = l->next) {
+		waiter = ilist_entry(l, struct tcb_s, wq_link);
+		if (!next || (waiter->priority & 0xff) < (next->priority & 0xff))
+			next = waiter;
+	}
+	ilist_remove(&next->wq_link);
+	ilist_remove(&m->link);
+	m->owner = next;
+	next->mutex_held++;
+	if (!ilist_empty(&m->waiters))
+		ilist_pushback(&next->mutexes, &m->link);
+
+	krnl_setprio(task, mutex_priority(task));
+	krnl_setprio(next, mutex_priority(next));
+	krnl_setstate(next, TASK_READY);
+	if ((next->priority & 0xff) < (task->priority & 0xff)) {
+		krnl_setnext(next);
+		preempt = 1;
+	}
+	CRITICAL_LEAVE();
+
+	if (preempt)
+		_yield();
+
+	return ERR_OK;
+}
@@ -24,7 +24,7 @@ static uint32_t nextpowerof2(uint32_t x)
 	return x;
 }
 
-struct pipe_s *ucx_pipe_create(uint16_t size)
+static struct pipe_s *pipe_create(uint16_t size, uint8_t spsc)
 {
 	struct pipe_s *pipe;
 	
@@ -47,11 +47,29 @@ struct pipe_s *ucx_pipe_create(uint16_t size)
 	}
 	pipe->head = 0;
 	pipe->tail = 0;
-	pipe->size = 0;
+	pipe->spsc = spsc;
+	ilist_init(&pipe->readers);
+	ilist_init(&pipe->writers);
 	
 	return pipe;
 }
 
+struct pipe_s *ucx_pipe_create(uint16_t size)
+{
+	return pipe_create(size, 0);
+}
+
+/*
+ * single producer / single consumer pipe. data is transferred without
+ * disabling interrupts, so an interrupt handler may be the producer (or the
+ * consumer) using the non blocking calls. a critical section is taken only
+ * to wake up (or put to sleep) a task waiting on the other side.
+ */
+struct pipe_s *ucx_pipe_create_spsc(uint16_t size)
+{
+	return pipe_create(size, 1);
+}
+
 int32_t ucx_pipe_destroy(struct pipe_s *pipe)
 {
 	if (!pipe->data)
@@ -64,88 +82,209 @@ int32_t ucx_pipe_destroy(struct pipe_s *pipe)
 	return 0;
 }
 
+/* discards pending data. on a SPSC pipe, must be called by the consumer. */
 void ucx_pipe_flush(struct pipe_s *pipe)
 {
 	CRITICAL_ENTER();
-	pipe->head = 0;
-	pipe->tail = 0;
-	pipe->size = 0;
+	pipe->head = pipe->tail;
+	krnl_wq_wakeup(&pipe->writers);
 	CRITICAL_LEAVE();
 }
 
 int32_t ucx_pipe_size(struct pipe_s *pipe)
 {
-	return pipe->size;
+	return __atomic_load_n(&pipe->tail, __ATOMIC_ACQUIRE) -
+		__atomic_load_n(&pipe->head, __ATOMIC_ACQUIRE);
 }
 
-static int32_t ucx_pipe_get(struct pipe_s *pipe)
+/*
+ * ring buffer transfers. head and tail are free running indexes, each one
+ * written by one side only (the consumer and the producer), so there is no
+ * shared counter. data is copied in (at most) two contiguous spans, one up
+ * to the end of the buffer and another from its start (wraparound). the
+ * index of the other side is loaded with acquire ordering, so the data it
+ * published is seen, and the own index is stored with release ordering,
+ * after the data is copied (this also holds across harts, on weakly ordered
+ * memory).
+ */
+static uint16_t pipe_get(struct pipe_s *pipe, char *data, uint16_t size)
 {
-	int32_t head, data;
+	uint32_t head = pipe->head, n, span;
 
-	if (pipe->head == pipe->tail)
-		return -1;
+	n = __atomic_load_n(&pipe->tail, __ATOMIC_ACQUIRE) - head;
+	if (n > size)
+		n = size;
+	span = pipe->mask + 1 - (head & pipe->mask);
+	if (span > n)
+		span = n;
 
-	CRITICAL_ENTER();	
-	head = pipe->head;
-	pipe->head = (pipe->head + 1) & pipe->mask;
-	data = pipe->data[head];
-	pipe->size--;
-	CRITICAL_LEAVE();
+	memcpy(data, pipe->data + (head & pipe->mask), span);
+	if (n > span)
+		memcpy(data + span, pipe->data, n - span);
+	__atomic_store_n(&pipe->head, head + n, __ATOMIC_RELEASE);
 
-	return data;
+	return n;
 }
 
-static int32_t ucx_pipe_put(struct pipe_s *pipe, char data)
+static uint16_t pipe_put(struct pipe_s *pipe, char *data, uint16_t size)
 {
-	int32_t tail;
+	uint32_t tail = pipe->tail, n, span;
 
-	tail = (pipe->tail + 1) & pipe->mask;
-	if (tail == pipe->head)
-		return -1;
-		
-	CRITICAL_ENTER();
-	pipe->data[pipe->tail] = data;
-	pipe->tail = tail;
-	pipe->size++;
-	CRITICAL_LEAVE();
+	n = pipe->mask + 1 - (tail - __atomic_load_n(&pipe->head, __ATOMIC_ACQUIRE));
+	if (n > size)
+		n = size;
+	span = pipe->mask + 1 - (tail & pipe->mask);
+	if (span > n)
+		span = n;
 
-	return 0;
+	memcpy(pipe->data + (tail & pipe->mask), data, span);
+	if (n > span)
+		memcpy(pipe->data, data + span, n - span);
+	__atomic_store_n(&pipe->tail, tail + n, __ATOMIC_RELEASE);
+
+	return n;
 }
 
-/* this routine is blocking and must be called inside a task. */
-int32_t ucx_pipe_read(struct pipe_s *pipe, char *data, uint16_t size)
+/*
+ * wakes up tasks waiting on the other side, if any. may be called from an
+ * interrupt handler (a SPSC producer or consumer), so interrupts are enabled
+ * again only if they were enabled before. a waiter checks the pipe and joins
+ * the wait queue inside one critical section. with a single hart nothing runs
+ * in between, so the queue may be checked without it. with SMP, the check is
+ * made under the kernel lock, otherwise it could miss a waiter that saw the
+ * pipe before our index store and is about to sleep.
+ */
+static void pipe_wakeup(struct ilist_s *wq)
 {
-	uint16_t i = 0;
-	int32_t byte;
-	
-	while (i < size) {
-		byte = ucx_pipe_get(pipe);
+	int32_t s;
 
-		if (byte == -1)
-			continue;
+#if NCPU == 1
+	if (ilist_empty(wq))
+		return;
+#endif
 
-		data[i] = byte;
-		i++;
+	s = _di();
+	krnl_lock();
+	krnl_wq_wakeup(wq);
+	krnl_unlock();
+	if (s)
+		_ei();
+}
+
+/*
+ * transfers up to size bytes. ticks is the transfer timeout, PIPE_NOWAIT
+ * returns immediately and PIPE_FOREVER waits until all data is transferred.
+ * a task waiting for data (or space) sleeps on the pipe wait queue, and is
+ * woken up when the other side transfers something. the pipe state is checked
+ * again before going to sleep, inside a critical section.
+ */
+static int32_t pipe_read(struct pipe_s *pipe, char *data, uint16_t size, int32_t ticks)
+{
+	uint32_t start = kcb->ticks, elapsed;
+	uint16_t i = 0, n, wait = 0;
+	int32_t timeout = 0;
+
+	for (;;) {
+		if (pipe->spsc) {
+			n = pipe_get(pipe, data + i, size - i);
+		} else {
+			CRITICAL_ENTER();
+			n = pipe_get(pipe, data + i, size - i);
+			CRITICAL_LEAVE();
+		}
+		if (n) {
+			i += n;
+			pipe_wakeup(&pipe->writers);
+		}
+		if (i == size || ticks == PIPE_NOWAIT || timeout)
+			break;
+		if (ticks != PIPE_FOREVER) {
+			elapsed = kcb->ticks - start;
+			if (elapsed >= ticks)
+				break;
+			wait = ticks - elapsed;
+		}
+		CRITICAL_ENTER();
+		if (pipe->tail == pipe->head) {
+			krnl_trace(TRACE_PIPE_BLOCK, pipe);
+			timeout = krnl_wq_wait(&pipe->readers, wait) == ERR_TIMEOUT;
+			krnl_trace(TRACE_PIPE_UNBLOCK, pipe);
+		}
+		CRITICAL_LEAVE();
 	}
-	
+
 	return i;
-	
+}
+
+static int32_t pipe_write(struct pipe_s *pipe, char *data, uint16_t size, int32_t ticks)
+{
+	uint32_t start = kcb->ticks, elapsed;
+	uint16_t i = 0, n, wait = 0;
+	int32_t timeout = 0;
+
+	for (;;) {
+		if (pipe->spsc) {
+			n = pipe_put(pipe, data + i, size - i);
+		} else {
+			CRITICAL_ENTER();
+			n = pipe_put(pipe, data + i, size - i);
+			CRITICAL_LEAVE();
+		}
+		if (n) {
+			i += n;
+			pipe_wakeup(&pipe->readers);
+		}
+		if (i == size || ticks == PIPE_NOWAIT || timeout)
+			break;
+		if (ticks != PIPE_FOREVER) {
+			elapsed = kcb->ticks - start;
+			if (elapsed >= ticks)
+				break;
+			wait = ticks - elapsed;
+		}
+		CRITICAL_ENTER();
+		if (pipe->tail - pipe->head == pipe->mask + 1) {
+			krnl_trace(TRACE_PIPE_BLOCK, pipe);
+			timeout = krnl_wq_wait(&pipe->writers, wait) == ERR_TIMEOUT;
+			krnl_trace(TRACE_PIPE_UNBLOCK, pipe);
+		}
+		CRITICAL_LEAVE();
+	}
+
+	return i;
+}
+/* this routine is blocking and must be called inside a task. */
+int32_t ucx_pipe_read(struct pipe_s *pipe, char *data, uint16_t size)
+{
+	return pipe_read(pipe, data, size, PIPE_FOREVER);
 }
 
 /* this routine is blocking and must be called inside a task. */
 int32_t ucx_pipe_write(struct pipe_s *pipe, char *data, uint16_t size)
 {
-	uint16_t i = 0;
-	int32_t res;
-	
-	while (i < size) {
-		res = ucx_pipe_put(pipe, data[i]);
+	return pipe_write(pipe, data, size, PIPE_FOREVER);
+}
 
-		if (res == -1)
-			continue;
+/* non blocking, returns the number of bytes read (may be less than size). */
+int32_t ucx_pipe_tryread(struct pipe_s *pipe, char *data, uint16_t size)
+{
+	return pipe_read(pipe, data, size, PIPE_NOWAIT);
+}
 
-		i++;
-	}
+/* non blocking, returns the number of bytes written (may be less than size). */
+int32_t ucx_pipe_trywrite(struct pipe_s *pipe, char *data, uint16_t size)
+{
+	return pipe_write(pipe, data, size, PIPE_NOWAIT);
+}
 
-	return i;
+/* blocks for up to ticks, returns the number of bytes read. */
+int32_t ucx_pipe_read_timeout(struct pipe_s *pipe, char *data, uint16_t size, uint16_t ticks)
+{
+	return pipe_read(pipe, data, size, ticks ? ticks : PIPE_NOWAIT);
+}
+
+/* blocks for up to ticks, returns the number of bytes written. */
+int32_t ucx_pipe_write_timeout(struct pipe_s *pipe, char *data, uint16_t size, uint16_t ticks)
+{
+	return pipe_write(pipe, data, size, ticks ? ticks : PIPE_NOWAIT);
 }
@@ -6,66 +6,93 @@
 
 #include <ucx.h>
 
+/*
+ * semaphore descriptors come from an object pool, and tasks waiting on a
+ * semaphore are linked through their TCBs (a kernel wait queue), so no memory
+ * is allocated for waiters. max_tasks is kept for compatibility only, as there
+ * is no limit on the number of waiting tasks.
+ */
+static struct pool_s *sem_pool;
+
 struct sem_s *ucx_sem_create(uint16_t max_tasks, int32_t value)
 {
 	struct sem_s *s;
 	
-	s = (struct sem_s *)malloc(sizeof(struct sem_s));
+	if (value < 0)
+		return 0;
+
+	s = ucx_pool_get(&sem_pool, sizeof(struct sem_s), SEM_POOL_SIZE) ?
+		ucx_pool_alloc(sem_pool) : 0;
 	
 	if (!s)
 		return 0;
 	
-	s->sem_queue = queue_create(max_tasks);
-	
-	if ((!s->sem_queue) || (value < 0)) {
-		free(s);
-		
-		return 0;
-	} else {
-		s->count = value;
+	ilist_init(&s->waiters);
+	s->count = value;
 
-		return s;
-	}
+	return s;
 }
 
 int32_t ucx_sem_destroy(struct sem_s *s)
 {
-	
-	if (queue_destroy(s->sem_queue)) {
+	if (!ilist_empty(&s->waiters))
 		return -1;
-	} else {
-		free(s);
-		
-		return 0;
-	}
+	
+	ucx_pool_free(sem_pool, s);
+	
+	return 0;
 }
 
 void ucx_sem_wait(struct sem_s *s)
 {
-	struct tcb_s *tcb_sem;
-	
+	struct tcb_s *task;
+
 	CRITICAL_ENTER();
+	krnl_trace(TRACE_SEM_WAIT, s);
 	s->count--;
 	if (s->count < 0) {
-		tcb_sem = kcb->task_current->data;
-		queue_enqueue(s->sem_queue, tcb_sem);
-		tcb_sem->state = TASK_BLOCKED;
-		CRITICAL_LEAVE();
-		ucx_task_wfi();
-	} else {
-		CRITICAL_LEAVE();
+		/* ucx_task_remove() gives the count back for a removed waiter */
+		task = krnl_cpu()->task_current;
+		task->sem_wait = s;
+		krnl_wq_wait(&s->waiters, 0);
+		task->sem_wait = 0;
 	}
+	CRITICAL_LEAVE();
 }
 
 void ucx_sem_signal(struct sem_s *s)
 {
-	struct tcb_s *tcb_sem;
+	CRITICAL_ENTER();
+	krnl_trace(TRACE_SEM_SIGNAL, s);
+	s->count++;
+	if (s->count <= 0)
+		krnl_wq_wakeone(&s->waiters);
+	CRITICAL_LEAVE();
+}
+
+/*
+ * same as ucx_sem_signal(), but if the woken up task has a higher priority
+ * than the signaling task, the processor is handed to it right away. must not
+ * be called from interrupt handlers.
+ */
+void ucx_sem_signal_preempt(struct sem_s *s)
+{
+	struct tcb_s *tcb_sem, *task;
+	int32_t preempt = 0;
 	
 	CRITICAL_ENTER();
+	krnl_trace(TRACE_SEM_SIGNAL, s);
 	s->count++;
 	if (s->count <= 0) {
-		tcb_sem = queue_dequeue(s->sem_queue);
-		tcb_sem->state = TASK_READY;
+		tcb_sem = krnl_wq_wakeone(&s->waiters);
+		task = krnl_cpu()->task_current;
+		if (tcb_sem && (tcb_sem->priority & 0xff) < (task->priority & 0xff)) {
+			krnl_setnext(tcb_sem);
+			preempt = 1;
+		}
 	}
 	CRITICAL_LEAVE();
+	
+	if (preempt)
+		_yield();
 }
@@ -153,14 +153,14 @@ int _sbrk(int incr)
 
 	prev_heap_end = heap_end;
 
-	if (heap_end + incr > (char *)_stack) {
+	if (heap_end + incr > (char *)&_stack) {
 		errno = ENOMEM;
 		return -1;
 	}
 
 	heap_end += incr;
 
-	return (int)prev_heap_end;
+	return (int)(size_t)prev_heap_end;
 }
 
 int _usleep(int usec)
@@ -244,7 +244,7 @@ int _tadd(void *task, int stack_size)
 
 int sys_task_add(void *task, int stack_size)
 {
-	return _syscall(SYS_TADD, task, (void *)stack_size, 0);
+	return _syscall(SYS_TADD, task, (void *)(size_t)stack_size, 0);
 }
 
 
@@ -255,7 +255,7 @@ int _tremove(int id)
 
 int sys_task_remove(int id)
 {
-	return _syscall(SYS_TREMOVE, (void *)id, 0, 0);
+	return _syscall(SYS_TREMOVE, (void *)(size_t)id, 0, 0);
 }
 
 
@@ -283,7 +283,7 @@ int _tdelay(int ticks)
 
 int sys_task_delay(int ticks)
 {
-	_syscall(SYS_TDELAY, (void *)ticks, 0, 0);
+	_syscall(SYS_TDELAY, (void *)(size_t)ticks, 0, 0);
 	
 	return 0;
 }
@@ -296,7 +296,7 @@ int _tsuspend(int id)
 
 int sys_task_suspend(int id)
 {
-	return _syscall(SYS_TSUSPEND, (void *)id, 0, 0);
+	return _syscall(SYS_TSUSPEND, (void *)(size_t)id, 0, 0);
 }
 
 
@@ -307,7 +307,7 @@ int _tresume(int id)
 
 int sys_task_resume(int id)
 {
-	return _syscall(SYS_TRESUME, (void *)id, 0, 0);
+	return _syscall(SYS_TRESUME, (void *)(size_t)id, 0, 0);
 }
 
 
@@ -318,7 +318,7 @@ int _tpriority(int id, int priority)
 
 int sys_task_priority(int id, int priority)
 {
-	return _syscall(SYS_TPRIORITY, (void *)id, (void *)priority, 0);
+	return _syscall(SYS_TPRIORITY, (void *)(size_t)id, (void *)(size_t)priority, 0);
 }
 
 
@@ -0,0 +1,215 @@
+/* file:          timer.c
+ * description:   software timers
+ * date:          10/2026
+ * author:        Sergio Johann Filho <sergio.johann@acad.pucrs.br>
+ */
+
+#include <ucx.h>
+
+/*
+ * Running timers are kept in a timer wheel, a hash of lists indexed by the
+ * expiration time modulo TIMER_WHEEL, so starting or stopping a timer takes
+ * constant time and on each tick only the timers of one slot are checked.
+ * Expired timers have their callbacks run by the timer task, which is added
+ * with the first timer that needs it, so any number of timers share a single
+ * stack. Callbacks of TIMER_ISR timers are run directly from the tick instead,
+ * in interrupt context (with the kernel lock held, on SMP). These must be
+ * short, and must not block or call functions that enter a critical section.
+ * An auto reload timer is restarted from its expiration time, so it does not
+ * drift. A timer that expires again before the timer task has run its
+ * callback has a single callback run.
+ */
+static struct {
+	struct ilist_s wheel[TIMER_WHEEL];
+	struct ilist_s expired;		/* expired timers, for the timer task */
+	struct ilist_s waiters;		/* the timer task, waiting for expired timers */
+	uint16_t running;
+	uint8_t task;
+} timers;
+
+static struct pool_s *timer_pool;
+
+void krnl_timer_init(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < TIMER_WHEEL; i++)
+		ilist_init(&timers.wheel[i]);
+	ilist_init(&timers.expired);
+	ilist_init(&timers.waiters);
+}
+
+static void timer_insert(struct timer_s *timer)
+{
+	ilist_pushback(&timers.wheel[timer->expire & TIMER_MASK], &timer->link);
+}
+
+static void timer_expire(struct timer_s *timer)
+{
+	ilist_remove(&timer->link);
+	if (timer->flags & TIMER_AUTORELOAD) {
+		timer->expire += timer->period;
+		/* periods lost (e.g. ticks skipped while idle) are not made up */
+		if ((int32_t)(timer->expire - kcb->ticks) <= 0)
+			timer->expire = kcb->ticks + timer->period;
+		timer_insert(timer);
+	} else {
+		timers.running--;
+	}
+
+	if (timer->flags & TIMER_ISR) {
+		timer->callback(timer->arg);
+	} else if (!ilist_linked(&timer->run_link)) {
+		ilist_pushback(&timers.expired, &timer->run_link);
+		krnl_wq_wakeup(&timers.waiters);
+	}
+}
+
+/*
+ * expires timers for the last ticks, called after the tick count is updated
+ * (by hart 0, with interrupts disabled). after a tickless sleep of a full
+ * turn of the wheel or more, all slots are checked.
+ */
+void krnl_timer_update(uint32_t ticks)
+{
+	struct ilist_s *l, *next;
+	struct timer_s *timer;
+	uint32_t i;
+
+	if (!timers.running)
+		return;
+
+	if (ticks > TIMER_WHEEL)
+		ticks = TIMER_WHEEL;
+
+	for (i = 0; i < ticks; i++) {
+		l = &timers.wheel[(kcb->ticks - i) & TIMER_MASK];
+		for (next = l->next; next != l; ) {
+			timer = ilist_entry(next, struct timer_s, link);
+			next = next->next;
+			if ((int32_t)(timer->expire - kcb->ticks) <= 0)
+				timer_expire(timer);
+		}
+	}
+}
+
+/* ticks until the first timer expires, for the tickless idle task */
+uint32_t krnl_timer_next(void)
+{
+	struct ilist_s *l;
+	struct timer_s *timer;
+	int32_t ticks, next = TICKLESS_MAX;
+	uint32_t i;
+
+	if (!timers.running)
+		return TICKLESS_MAX;
+
+	for (i = 0; i < TIMER_WHEEL; i++) {
+		for (l = timers.wheel[i].next; l != &timers.wheel[i]; l = l->next) {
+			timer = ilist_entry(l, struct timer_s, link);
+			ticks = timer->expire - kcb->ticks;
+			if (ticks < next)
+				next = ticks > 0 ? ticks : 1;
+		}
+	}
+
+	return next;
+}
+
+/* runs the callbacks of expired timers (other than TIMER_ISR) */
+static void timer_task(void)
+{
+	struct ilist_s *l;
+	struct timer_s *timer;
+	void (*callback)(void *);
+	void *arg;
+
+	ucx_task_priority(ucx_task_id(), TASK_HIGH_PRIO);
+
+	for (;;) {
+		CRITICAL_ENTER();
+		while (!(l = ilist_pop(&timers.expired)))
+			krnl_wq_wait(&timers.waiters, 0);
+		timer = ilist_entry(l, struct timer_s, run_link);
+		callback = timer->callback;
+		arg = timer->arg;
+		CRITICAL_LEAVE();
+
+		callback(arg);
+	}
+}
+
+/*
+ * creates a (stopped) timer, which calls callback(arg) period ticks after it
+ * is started, once (TIMER_ONESHOT) or every period ticks (TIMER_AUTORELOAD).
+ */
+struct timer_s *ucx_timer_create(void (*callback)(void *), void *arg, uint16_t period, uint8_t flags)
+{
+	struct timer_s *timer;
+	uint8_t task;
+
+	if (!callback || !period)
+		return 0;
+
+	timer = ucx_pool_get(&timer_pool, sizeof(struct timer_s), TIMER_POOL_SIZE) ?
+		ucx_pool_alloc(timer_pool) : 0;
+
+	if (!timer)
+		return 0;
+
+	if (!(flags & TIMER_ISR)) {
+		CRITICAL_ENTER();
+		task = timers.task;
+		timers.task = 1;
+		CRITICAL_LEAVE();
+		if (!task)
+			ucx_task_add(timer_task, DEFAULT_STACK_SIZE);
+	}
+
+	ilist_init(&timer->link);
+	ilist_init(&timer->run_link);
+	timer->callback = callback;
+	timer->arg = arg;
+	timer->period = period;
+	timer->flags = flags;
+
+	return timer;
+}
+
+/* stops and frees a timer. must not be called while its callback runs. */
+int32_t ucx_timer_destroy(struct timer_s *timer)
+{
+	ucx_timer_stop(timer);
+	ucx_pool_free(timer_pool, timer);
+
+	return ERR_OK;
+}
+
+/* starts a timer, to expire period ticks from now (restarts a running timer) */
+int32_t ucx_timer_start(struct timer_s *timer)
+{
+	CRITICAL_ENTER();
+	if (ilist_linked(&timer->link))
+		ilist_remove(&timer->link);
+	else
+		timers.running++;
+	timer->expire = kcb->ticks + timer->period;
+	timer_insert(timer);
+	CRITICAL_LEAVE();
+
+	return ERR_OK;
+}
+
+/* stops a timer. a callback that is pending on the timer task is dropped. */
+int32_t ucx_timer_stop(struct timer_s *timer)
+{
+	CRITICAL_ENTER();
+	if (ilist_linked(&timer->link)) {
+		ilist_remove(&timer->link);
+		timers.running--;
+	}
+	ilist_remove(&timer->run_link);
+	CRITICAL_LEAVE();
+
+	return ERR_OK;
+}
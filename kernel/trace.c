@@ -0,0 +1,123 @@
+/* file:          trace.c
+ * description:   kernel event tracing
+ * date:          10/2026
+ * author:        Sergio Johann Filho <sergio.johann@acad.pucrs.br>
+ */
+
+#include <ucx.h>
+
+/*
+ * Trace records are kept in a ring buffer of fixed size records, as:
+ *
+ *   time (us) | event << 16 | task id | argument
+ *
+ * The ring works as a flight recorder: a writer takes the next record by
+ * moving a free running index (with an atomic add, where the architecture has
+ * one) and the oldest records are overwritten, so writing takes the same time
+ * no matter the state of the buffer and nobody is kept waiting. Without the
+ * atomic add the index is moved by plain code, which is fine as every kernel
+ * trace point runs with interrupts disabled.
+ *
+ * ucx_trace_dump() sends the most recent records to the console as lines of
+ * hex words prefixed by '#T', and tools/trace2json.py turns them into a
+ * timeline that can be viewed in the Perfetto UI or chrome://tracing.
+ */
+
+#ifdef TRACE
+
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_2)
+#define TRACE_ATOMIC
+#endif
+
+struct trace_rec_s {
+	uint32_t time;
+	uint32_t info;
+	uint32_t arg;
+};
+
+static struct {
+	struct trace_rec_s rec[TRACE_SIZE];
+	volatile uint16_t head;			/* free running index */
+	volatile uint8_t full;			/* the buffer has wrapped around */
+	volatile uint8_t paused;
+} ring;
+
+void krnl_trace_put(uint8_t event, uint32_t arg)
+{
+	struct tcb_s *task = krnl_cpu()->task_current;
+	struct trace_rec_s *rec;
+	uint16_t pos;
+
+	if (ring.paused)
+		return;
+
+#ifdef TRACE_ATOMIC
+	pos = __atomic_fetch_add(&ring.head, 1, __ATOMIC_RELAXED);
+#else
+	pos = ring.head++;
+#endif
+	if (pos == TRACE_SIZE - 1)
+		ring.full = 1;
+	rec = &ring.rec[pos & (TRACE_SIZE - 1)];
+	rec->time = _read_us();
+	rec->info = ((uint32_t)event << 16) | (task ? task->id : 0xffff);
+	rec->arg = arg;
+}
+
+static void trace_hex(uint32_t val)
+{
+	int8_t i;
+	char c;
+
+	_putchar(' ');
+	for (i = 28; i >= 0; i -= 4) {
+		c = (val >> i) & 0xf;
+		_putchar(c > 9 ? c + 'a' - 10 : c + '0');
+	}
+}
+
+/*
+ * sends the recorded events to the console, oldest first, and empties the
+ * buffer. recording is paused meanwhile, and the number of records sent is
+ * returned.
+ */
+int32_t ucx_trace_dump(void)
+{
+	struct trace_rec_s *rec;
+	uint16_t head, n, i;
+
+	ring.paused = 1;
+	head = ring.head;
+	n = ring.full ? TRACE_SIZE : head;
+
+	for (i = head - n; i != head; i++) {
+		rec = &ring.rec[i & (TRACE_SIZE - 1)];
+		_putchar('#');
+		_putchar('T');
+		trace_hex(rec->time);
+		trace_hex(rec->info);
+		trace_hex(rec->arg);
+		_putchar('\n');
+	}
+
+	CRITICAL_ENTER();
+	ring.head = 0;
+	ring.full = 0;
+	ring.paused = 0;
+	CRITICAL_LEAVE();
+
+	return n;
+}
+
+#else
+
+void krnl_trace_put(uint8_t event, uint32_t arg)
+{
+}
+
+int32_t ucx_trace_dump(void)
+{
+	return ERR_FAIL;
+}
+
+#endif
@@ -7,11 +7,11 @@
 #include <ucx.h>
 
 struct kcb_s kernel_state = {
-	.tasks = 0,
-	.task_current = 0,
+	.lock = 0,
 	.events = 0,
 	.id_next = 0,
-	.ticks = 0
+	.ticks = 0,
+	.ticks_hi = 0
 };
 	
 struct kcb_s *kcb = &kernel_state;
@@ -21,7 +21,7 @@ struct kcb_s *kcb = &kernel_state;
 
 static void stack_check(void)
 {
-	struct tcb_s *task = kcb->task_current->data;
+	struct tcb_s *task = krnl_cpu()->task_current;
 	uint32_t check = 0x33333333;
 	uint32_t *stack_p = (uint32_t *)task->stack;
 
@@ -34,28 +34,183 @@ static void stack_check(void)
 		
 }
 
-static struct node_s *delay_update(struct node_s *node, void *arg)
+/*
+ * Delayed tasks are kept in a delta list, sorted by wakeup time. Each task
+ * delay is relative to the previous task on the list, so on each tick only
+ * the head is decremented and expired tasks are taken from the front.
+ */
+static void delay_insert(struct tcb_s *task, uint16_t ticks)
 {
-	struct tcb_s *task = node->data;
-	
-	if (task->state == TASK_BLOCKED && task->delay > 0) {
-		task->delay--;
-		if (task->delay == 0)
-			task->state = TASK_READY;
+	struct ilist_s *l = kcb->delay_list.next;
+	struct tcb_s *next;
+
+	for (; l != &kcb->delay_list; l = l->next) {
+		next = ilist_entry(l, struct tcb_s, delay_link);
+		if (next->delay > ticks) {
+			next->delay -= ticks;
+			break;
+		}
+		ticks -= next->delay;
 	}
-	
-	return 0;
+
+	task->delay = ticks;
+	ilist_pushback(l, &task->delay_link);
 }
 
-static struct node_s *idcmp(struct node_s *node, void *arg)
+static void delay_remove(struct tcb_s *task)
 {
-	struct tcb_s *task = node->data;
-	uint16_t id = (size_t)arg;
-	
-	if (task->id == id)
-		return node;
-	else
+	struct ilist_s *l = task->delay_link.next;
+
+	if (!ilist_linked(&task->delay_link))
+		return;
+
+	if (l != &kcb->delay_list)
+		ilist_entry(l, struct tcb_s, delay_link)->delay += task->delay;
+	ilist_remove(&task->delay_link);
+}
+
+/*
+ * Wait queues. Tasks blocked on a kernel object (waiting for data on a pipe,
+ * for example) are kept in a FIFO list, linked through the TCBs. A task may
+ * wait with a timeout, being on the delay list at the same time. Both calls
+ * must be made inside a critical section, so checking for a condition and
+ * going to sleep is atomic. krnl_wq_wait() leaves the critical section while
+ * the task is blocked, and returns ERR_TIMEOUT if the task was woken up by
+ * its timeout. krnl_wq_wakeup() wakes up all tasks on a wait queue, which are
+ * expected to check their condition again. krnl_wq_wakeone() wakes up only the
+ * oldest waiter, and returns it.
+ */
+int32_t krnl_wq_wait(struct ilist_s *wq, uint16_t ticks)
+{
+	struct tcb_s *task = krnl_cpu()->task_current;
+
+	ilist_pushback(wq, &task->wq_link);
+	if (ticks)
+		delay_insert(task, ticks);
+	krnl_setstate(task, TASK_BLOCKED);
+	krnl_yield();
+
+	if (ilist_linked(&task->wq_link)) {
+		ilist_remove(&task->wq_link);
+
+		return ERR_TIMEOUT;
+	}
+	if (ticks)
+		delay_remove(task);
+
+	return ERR_OK;
+}
+
+void krnl_wq_wakeup(struct ilist_s *wq)
+{
+	struct ilist_s *l;
+	struct tcb_s *task;
+
+	while ((l = ilist_pop(wq))) {
+		task = ilist_entry(l, struct tcb_s, wq_link);
+		if (task->state == TASK_BLOCKED)
+			krnl_setstate(task, TASK_READY);
+	}
+}
+
+struct tcb_s *krnl_wq_wakeone(struct ilist_s *wq)
+{
+	struct ilist_s *l;
+	struct tcb_s *task;
+
+	l = ilist_pop(wq);
+	if (!l)
+		return 0;
+
+	task = ilist_entry(l, struct tcb_s, wq_link);
+	if (task->state == TASK_BLOCKED)
+		krnl_setstate(task, TASK_READY);
+
+	return task;
+}
+
+/*
+ * Task ids index a table of TCBs, so a task is found in constant time. Ids of
+ * removed tasks are recycled, the lowest free id being taken by a new task,
+ * and the table is doubled when it runs full. The table is allocated (and
+ * grown) outside the critical section, and swapped in inside it.
+ */
+static int32_t task_id_alloc(struct tcb_s *task)
+{
+	struct tcb_s **ids, **old;
+	uint16_t id, size;
+
+	for (;;) {
+		CRITICAL_ENTER();
+		for (id = kcb->id_next; id < kcb->task_ids_max && kcb->task_ids[id]; id++);
+		if (id < kcb->task_ids_max) {
+			kcb->task_ids[id] = task;
+			kcb->id_next = id + 1;
+			task->id = id;
+			CRITICAL_LEAVE();
+
+			return id;
+		}
+		size = kcb->task_ids_max;
+		CRITICAL_LEAVE();
+
+		ids = malloc((size ? size * 2 : TASK_IDS) * sizeof(struct tcb_s *));
+		if (!ids)
+			return -1;
+		memset(ids, 0, (size ? size * 2 : TASK_IDS) * sizeof(struct tcb_s *));
+
+		CRITICAL_ENTER();
+		old = ids;
+		if (size == kcb->task_ids_max) {
+			old = kcb->task_ids;
+			if (size)
+				memcpy(ids, old, size * sizeof(struct tcb_s *));
+			kcb->task_ids = ids;
+			kcb->task_ids_max = size ? size * 2 : TASK_IDS;
+		}
+		CRITICAL_LEAVE();
+		if (old)
+			free(old);
+	}
+}
+
+static void task_id_free(uint16_t id)
+{
+	kcb->task_ids[id] = 0;
+	if (id < kcb->id_next)
+		kcb->id_next = id;
+}
+
+/* finds a task by its id. must be called inside a critical section */
+static struct tcb_s *task_find(uint16_t id)
+{
+	if (id >= kcb->task_ids_max)
 		return 0;
+
+	return kcb->task_ids[id];
+}
+
+/* advance delayed tasks by a number of ticks, waking up expired ones */
+void krnl_delay_update(uint32_t ticks)
+{
+	struct tcb_s *task;
+
+	while (ticks && !ilist_empty(&kcb->delay_list)) {
+		task = ilist_entry(kcb->delay_list.next, struct tcb_s, delay_link);
+		if (task->delay > ticks) {
+			task->delay -= ticks;
+			break;
+		}
+		ticks -= task->delay;
+		task->delay = 0;
+		while (!task->delay) {
+			ilist_remove(&task->delay_link);
+			krnl_setstate(task, TASK_READY);
+			if (ilist_empty(&kcb->delay_list))
+				break;
+			task = ilist_entry(kcb->delay_list.next, struct tcb_s, delay_link);
+		}
+	}
 }
 
 void krnl_panic(uint32_t ecode)
@@ -80,41 +235,424 @@ void krnl_panic(uint32_t ecode)
 void _dispatch(void) __attribute__ ((weak, alias ("dispatch")));
 void _yield(void) __attribute__ ((weak, alias ("yield")));
 
+/*
+ * Ready queues. Tasks on the READY state are kept in a circular array of
+ * RQ_SLOTS queues, indexed by a bitmap of non empty slots. A task becoming
+ * ready is appended to the slot that lies a priority dependent distance ahead
+ * of the current slot (rq_time), so tasks with a higher priority are
+ * placed closer and are picked more often. The distance is derived from the
+ * task priority (8 MSBs), so TASK_CRIT_PRIO tasks are placed 1 slot ahead
+ * and TASK_IDLE_PRIO tasks 32 slots ahead. The running task is never kept in
+ * a ready queue.
+ *
+ * Each hart has its own ready queues. A READY task is queued on the hart
+ * given by task->cpu, the hart it last ran on, unless its affinity mask
+ * doesn't allow it (then the first allowed hart is used). A hart with no
+ * ready tasks steals the next task of the hart with most ready tasks, among
+ * those allowed to run on it.
+ */
+
+static uint8_t rq_ffs(uint32_t x)
+{
+	uint8_t n = 0;
+
+	if (!(x & 0x0000ffff)) {
+		n += 16;
+		x >>= 16;
+	}
+	if (!(x & 0x000000ff)) {
+		n += 8;
+		x >>= 8;
+	}
+	if (!(x & 0x0000000f)) {
+		n += 4;
+		x >>= 4;
+	}
+	if (!(x & 0x00000003)) {
+		n += 2;
+		x >>= 2;
+	}
+	if (!(x & 0x00000001))
+		n += 1;
+
+	return n;
+}
+
+/*
+ * Real time tasks (added with ucx_task_rt_add()) are not kept on the ready
+ * queues, but on a single queue sorted by absolute deadline, which all harts
+ * search first (earliest deadline first). A job of a task is released once
+ * per period and may run for its capacity in ticks, charged by the tick. A
+ * job still running after its capacity is used up counts as a miss, and the
+ * task is throttled until its next release.
+ */
+static void rt_insert(struct tcb_s *task)
+{
+	struct ilist_s *l;
+
+	for (l = kcb->rt_queue.next; l != &kcb->rt_queue; l = l->next)
+		if ((int32_t)(ilist_entry(l, struct tcb_s, rt_link)->rt_due - task->rt_due) > 0)
+			break;
+	ilist_pushback(l, &task->rt_link);
+}
+
+/* ready real time task with the earliest deadline allowed on the calling hart */
+static struct tcb_s *rt_first(void)
+{
+	struct ilist_s *l;
+	struct tcb_s *task;
+
+	for (l = kcb->rt_queue.next; l != &kcb->rt_queue; l = l->next) {
+		task = ilist_entry(l, struct tcb_s, rt_link);
+		if (task->affinity & ((uint32_t)1 << krnl_cpu_id()))
+			return task;
+	}
+
+	return 0;
+}
+
+/* density (capacity / deadline) of a real time task, per 1000, rounded up */
+static uint16_t rt_density(uint16_t capacity, uint16_t deadline)
+{
+	return ((uint32_t)capacity * 1000 + deadline - 1) / deadline;
+}
+
+/* moves a real time task to its next job */
+static void rt_next(struct tcb_s *task)
+{
+	task->rt_release += task->rt_period;
+	task->rt_due = task->rt_release + task->rt_deadline;
+	task->rt_budget = task->rt_capacity;
+}
+
+/* blocks a real time task until the release of its job, if it is ahead */
+static int32_t rt_sleep(struct tcb_s *task)
+{
+	int32_t ticks = task->rt_release - kcb->ticks;
+
+	if (ticks <= 0)
+		return 0;
+
+	delay_insert(task, ticks);
+	krnl_setstate(task, TASK_BLOCKED);
+
+	return 1;
+}
+
+/* charges a tick to a running real time task */
+static void rt_charge(struct tcb_s *task)
+{
+	if (task->rt_budget) {
+		task->rt_budget--;
+
+		return;
+	}
+
+	task->rt_misses++;
+	rt_next(task);
+	rt_sleep(task);
+}
+
+static void rq_insert(struct tcb_s *task)
+{
+	struct cpu_s *cpu;
+	struct tcb_s *head;
+	uint16_t step;
+	uint8_t slot;
+
+	if (task->rt_period) {
+		rt_insert(task);
+
+		return;
+	}
+
+#if NCPU > 1
+	if (!(task->affinity & ((uint32_t)1 << task->cpu)))
+		task->cpu = rq_ffs(task->affinity);
+#endif
+	cpu = &kcb->cpu[task->cpu];
+	/* a step past the last slot would wrap around ahead of every other task */
+	step = (((task->priority >> 8) & 0xff) + 1) >> 2;
+	if (step > RQ_MASK)
+		step = RQ_MASK;
+	slot = (cpu->rq_time + step) & RQ_MASK;
+	head = cpu->rq[slot];
+
+	if (head) {
+		task->rq_next = head;
+		task->rq_prev = head->rq_prev;
+		head->rq_prev->rq_next = task;
+		head->rq_prev = task;
+	} else {
+		task->rq_next = task;
+		task->rq_prev = task;
+		cpu->rq[slot] = task;
+		cpu->rq_map[slot >> 5] |= (uint32_t)1 << (slot & 31);
+	}
+	task->rq_slot = slot;
+	cpu->rq_count++;
+}
+
+static void rq_remove(struct tcb_s *task)
+{
+	struct cpu_s *cpu = &kcb->cpu[task->cpu];
+	uint8_t slot = task->rq_slot;
+
+	if (task->rt_period) {
+		ilist_remove(&task->rt_link);
+
+		return;
+	}
+
+	if (task->rq_next == task) {
+		cpu->rq[slot] = 0;
+		cpu->rq_map[slot >> 5] &= ~((uint32_t)1 << (slot & 31));
+	} else {
+		task->rq_prev->rq_next = task->rq_next;
+		task->rq_next->rq_prev = task->rq_prev;
+		if (cpu->rq[slot] == task)
+			cpu->rq[slot] = task->rq_next;
+	}
+	cpu->rq_count--;
+}
+
+/* first non empty slot, searching from the current one (RQ_SLOTS == 64) */
+static int32_t rq_first(struct cpu_s *cpu)
+{
+	uint8_t w = cpu->rq_time >> 5;
+	uint8_t b = cpu->rq_time & 31;
+	uint32_t m;
+
+	if ((m = cpu->rq_map[w] & (0xffffffff << b)))
+		return (w << 5) + rq_ffs(m);
+	if ((m = cpu->rq_map[w ^ 1]))
+		return ((w ^ 1) << 5) + rq_ffs(m);
+	if ((m = cpu->rq_map[w]))
+		return (w << 5) + rq_ffs(m);
+
+	return -1;
+}
+
+#if NCPU > 1
+/* next task on the ready queues of a hart (in scheduling order) allowed by a mask */
+static struct tcb_s *rq_next(struct cpu_s *cpu, uint32_t mask)
+{
+	struct tcb_s *task;
+	uint8_t i, slot;
+
+	for (i = 0; i < RQ_SLOTS; i++) {
+		slot = (cpu->rq_time + i) & RQ_MASK;
+		task = cpu->rq[slot];
+		if (!task)
+			continue;
+		do {
+			if (task->affinity & mask)
+				return task;
+			task = task->rq_next;
+		} while (task != cpu->rq[slot]);
+	}
+
+	return 0;
+}
+
+/* a task to be run by a hart that has no ready tasks, taken from the busiest hart */
+static struct tcb_s *rq_steal(uint8_t id)
+{
+	struct tcb_s *task, *found = 0;
+	uint16_t count = 0;
+	uint8_t i;
+
+	for (i = 0; i < NCPU; i++) {
+		if (i == id || kcb->cpu[i].rq_count <= count)
+			continue;
+		task = rq_next(&kcb->cpu[i], (uint32_t)1 << id);
+		if (task) {
+			found = task;
+			count = kcb->cpu[i].rq_count;
+		}
+	}
+
+	return found;
+}
+#endif
+
+/* idle tasks are bound to their hart, so this holds only for them */
+#define task_idle(task)		(kcb->cpu[(task)->cpu].idle == (task))
+
+#if NCPU > 1
+/*
+ * interrupts a hart that is running its idle task to run a ready task, the
+ * hart the task is queued on or another hart that may steal it.
+ */
+static void cpu_wakeup(struct tcb_s *task)
+{
+	uint8_t i, n, id = krnl_cpu_id();
+	struct cpu_s *cpu;
+
+	for (i = 0; i < NCPU; i++) {
+		n = (task->cpu + i) % NCPU;
+		cpu = &kcb->cpu[n];
+		if (n != id && (task->affinity & ((uint32_t)1 << n)) &&
+		    cpu->task_current && cpu->task_current == cpu->idle) {
+			_cpu_notify(n);
+			break;
+		}
+	}
+}
+#endif
+
+/*
+ * All task state changes go through here, so a task is kept in a ready queue
+ * if and only if it is on the READY state. The kernel idle tasks (if any) are
+ * never queued, a hart picks its idle task only when all ready queues are
+ * empty. Must be called with interrupts disabled (inside a critical section
+ * or from the dispatcher). With SMP, a task becoming ready wakes up an idle
+ * hart, if there is one (not when a running task is put back on the queues
+ * of its own hart).
+ */
+void krnl_setstate(struct tcb_s *task, uint8_t state)
+{
+	if (!task_idle(task)) {
+		if (task->state == TASK_READY && state != TASK_READY) {
+			rq_remove(task);
+		} else if (task->state != TASK_READY && state == TASK_READY) {
+			rq_insert(task);
+#if NCPU > 1
+			if (task->state != TASK_RUNNING || task->cpu != krnl_cpu_id())
+				cpu_wakeup(task);
+#endif
+		}
+	}
+
+	task->state = state;
+}
+
+/*
+ * Changes a task priority, moving a READY task to the ready queue slot of its
+ * new priority. Used by mutexes to pass priorities on to their owners. Must
+ * be called with interrupts disabled.
+ */
+void krnl_setprio(struct tcb_s *task, uint16_t priority)
+{
+	if (task->state == TASK_READY && !task_idle(task)) {
+		rq_remove(task);
+		task->priority = priority;
+		rq_insert(task);
+	} else {
+		task->priority = priority;
+	}
+}
+
+/*
+ * Moves a READY task to the head of the current ready queue slot, so it is
+ * the next task to be selected by the scheduler. Used to preempt the running
+ * task in favor of a task that was just woken up. Must be called with
+ * interrupts disabled. Real time tasks are kept in deadline order.
+ */
+void krnl_setnext(struct tcb_s *task)
+{
+	struct cpu_s *cpu;
+	struct tcb_s *head;
+	uint8_t slot;
+
+	if (task->state != TASK_READY || task_idle(task) || task->rt_period)
+		return;
+
+	rq_remove(task);
+#if NCPU > 1
+	/* to the calling hart, if the task may run on it */
+	if (task->affinity & ((uint32_t)1 << krnl_cpu_id()))
+		task->cpu = krnl_cpu_id();
+#endif
+	cpu = &kcb->cpu[task->cpu];
+	slot = cpu->rq_time;
+	head = cpu->rq[slot];
+	if (head) {
+		task->rq_next = head;
+		task->rq_prev = head->rq_prev;
+		head->rq_prev->rq_next = task;
+		head->rq_prev = task;
+	} else {
+		task->rq_next = task;
+		task->rq_prev = task;
+		cpu->rq_map[slot >> 5] |= (uint32_t)1 << (slot & 31);
+	}
+	cpu->rq[slot] = task;
+	task->rq_slot = slot;
+	cpu->rq_count++;
+}
+
 /*
  * The scheduler switches tasks based on task states and priorities, using
  * a priority driven round robin algorithm. Current interrupted task is checked
- * for its state and if RUNNING, it is changed to READY. Task priority is
- * kept in the TCB entry in 16 bits, where the 8 MSBs hold the task
- * priority and the 8 LSBs keep current task priority, decremented on each
- * round - so high priority tasks have a higher chance of 'winning' the cpu.
- * Only a task on the READY state is considered as a viable option. NOTICE - 
- * if no task is ready (e.g. no 'idle' task added to the system and no other
- * task ready) the kernel will hang forever in that inner do .. while loop
- * and this is fine, as there is no hope in such system.
+ * for its state and if RUNNING, it is changed to READY and put back on a ready
+ * queue. The first task on the nearest non empty slot is selected, and the
+ * current slot moves forward to it - so high priority tasks, which are placed
+ * closer, have a higher chance of 'winning' the cpu. Selection takes constant
+ * time, no matter how many tasks are in the system. If no task is ready, the
+ * kernel idle task of the hart is selected (TICKLESS or SMP builds). Ready
+ * real time tasks are selected before all others, by deadline. With SMP,
+ * each hart schedules its own current task from its own ready queues (with
+ * the kernel lock held), and steals a task from another hart before going
+ * idle. NOTICE - without an idle task, if no
+ * task is ready (e.g. no 'idle' task added to the system and no other task
+ * ready) there is no hope in such system, and the kernel panics.
  * 
- * In the end, a task is selected for execution, has its priority reassigned
- * and its state changed to RUNNING.
+ * In the end, a task is selected for execution and its state is changed to
+ * RUNNING. The time the current task has run since it was selected is added
+ * to its run time, and a switch to another task is counted as involuntary
+ * (a preemption) if the scheduler was called from the tick while the task
+ * could still run, or as voluntary otherwise.
  */
 
 uint16_t krnl_schedule(void)
 {
-	struct tcb_s *task = kcb->task_current->data;
+	struct cpu_s *cpu = krnl_cpu();
+	struct tcb_s *prev, *task = cpu->task_current;
+	uint64_t now;
+	int32_t slot;
 	
+	now = _read_us();
+	task->run_time += now - cpu->run_start;
+	cpu->run_start = now;
+	prev = task;
+
+	if (cpu->in_tick && task->rt_period && task->state == TASK_RUNNING)
+		rt_charge(task);
 	if (task->state == TASK_RUNNING)
-		task->state = TASK_READY;
-		
-	do {
-		do {
-			kcb->task_current = kcb->task_current->next;
-			if (kcb->task_current == kcb->tasks->tail)
-				kcb->task_current = kcb->tasks->head->next;
-				
-			task = kcb->task_current->data;
-		} while (task->state != TASK_READY);
-	} while (--task->priority & 0xff);
-	
-	task->priority |= (task->priority >> 8) & 0xff;
-	task->state = TASK_RUNNING;
+		krnl_setstate(task, TASK_READY);
+
+	task = rt_first();
+	if (!task) {
+		slot = rq_first(cpu);
+		if (slot >= 0) {
+			cpu->rq_time = slot;
+			task = cpu->rq[slot];
+		} else {
+#if NCPU > 1
+			task = rq_steal(krnl_cpu_id());
+#endif
+			if (!task)
+				task = cpu->idle;
+			if (!task)
+				krnl_panic(ERR_NO_TASKS);
+		}
+	}
+	if (task != prev) {
+		if (cpu->in_tick && prev->state == TASK_READY)
+			prev->preemptions++;
+		else
+			prev->switches++;
+		krnl_trace(TRACE_SWITCH_OUT, prev->state);
+	}
+	krnl_setstate(task, TASK_RUNNING);
+	task->cpu = krnl_cpu_id();
+	cpu->task_current = task;
+	if (task != prev)
+		krnl_trace(TRACE_SWITCH_IN, task->priority & 0xff);
+	if (cpu->in_tick)
+		krnl_trace(TRACE_ISR_EXIT, 0);
+	cpu->in_tick = 0;
 	
 	return task->id;
 }
@@ -128,121 +666,407 @@ uint16_t krnl_schedule(void)
  * specific hardware support or expectations for the context switch, the mechanism
  * should be defined in the HAL, implementing both _dispatch() and _yield().
  * 
+ * With SMP, the kernel lock is held from the moment the context of a task is
+ * saved until another context is restored, and it is released by the task
+ * that is switched in (in dispatch(), yield() or task_start()). A task may
+ * be switched out on one hart and resumed on another. Only hart 0 counts
+ * ticks and wakes up delayed tasks.
+ *
  * You are not expected to understand this.
  */
 
+/*
+ * accounts for ticks that have passed: counts them (the high word is read
+ * together with the low word by ucx_ticks64()), wakes up delayed tasks and
+ * expires software timers. called with the kernel lock held, by the tick
+ * (dispatch() or a HAL _dispatch()), by each task switch in cooperative mode
+ * and by the idle task (or the HAL) after a tickless sleep.
+ */
+void krnl_tick(uint32_t ticks)
+{
+	if (kcb->ticks + ticks < kcb->ticks)
+		kcb->ticks_hi++;
+	kcb->ticks += ticks;
+	krnl_delay_update(ticks);
+	krnl_timer_update(ticks);
+}
+
 void krnl_dispatcher(void)
 {
-	kcb->ticks++;
+	krnl_cpu()->in_tick = 1;
+	krnl_trace(TRACE_ISR_ENTER, 0);
 	_dispatch();
 }
 
 void dispatch(void)
 {
-	struct tcb_s *task = kcb->task_current->data;
+	struct tcb_s *task;
 	
-	if (!kcb->tasks->length)
+	krnl_lock();
+	if (!kcb->task_count)
 		krnl_panic(ERR_NO_TASKS);
 	
+	task = krnl_cpu()->task_current;
 	if (!setjmp(task->context)) {
 		stack_check();
-		list_foreach(kcb->tasks, delay_update, (void *)0);
+		if (!krnl_cpu_id())
+			krnl_tick(1);
 		krnl_schedule();
 		_interrupt_tick();
-		task = kcb->task_current->data;
+		task = krnl_cpu()->task_current;
 		longjmp(task->context, 1);
 	}
+	krnl_unlock();
 }
 
-void yield(void)
+/* switches to the next task, inside a critical section */
+static void task_switch(void)
 {
-	struct tcb_s *task = kcb->task_current->data;
-	
-	if (!kcb->tasks->length)
-		krnl_panic(ERR_NO_TASKS);
-	
+	struct tcb_s *task = krnl_cpu()->task_current;
+
 	if (!setjmp(task->context)) {
 		stack_check();
+		/* in cooperative mode, each switch counts as a tick */
 		if (kcb->preemptive == 'n')
-			list_foreach(kcb->tasks, delay_update, (void *)0);
+			krnl_tick(1);
 		krnl_schedule();
-		task = kcb->task_current->data;
+		task = krnl_cpu()->task_current;
 		longjmp(task->context, 1);
 	}
 }
 
+void yield(void)
+{
+	if (!kcb->task_count)
+		krnl_panic(ERR_NO_TASKS);
+	
+	/* keep the tick from running the scheduler while the queues are being updated */
+	CRITICAL_ENTER();
+	task_switch();
+	CRITICAL_LEAVE();
+}
+
+/*
+ * gives up the processor from inside a critical section, which is left while
+ * other tasks run. with SMP the kernel lock is kept until the context is
+ * saved, so a task that has just blocked is not resumed by another hart
+ * before it has switched out.
+ */
+void krnl_yield(void)
+{
+#if NCPU > 1
+	task_switch();
+#else
+	CRITICAL_LEAVE();
+	_yield();
+	CRITICAL_ENTER();
+#endif
+}
+
+/* current task of the calling hart (interrupts are masked, so it can't move) */
+struct tcb_s *krnl_current(void)
+{
+#if NCPU > 1
+	struct tcb_s *task;
+	int32_t s;
+
+	s = _di();
+	task = krnl_cpu()->task_current;
+	if (s)
+		_ei();
+
+	return task;
+#else
+	return kcb->cpu[0].task_current;
+#endif
+}
+
+
+#if defined(TICKLESS) || NCPU > 1
+/*
+ * Kernel idle task, selected by the scheduler only when no other task is
+ * ready. With the tick enabled, the HAL is asked to sleep until the first
+ * delayed task or software timer is due (or for TICKLESS_MAX ticks, if none)
+ * with the tick timer programmed as a one shot timer. The ticks that passed
+ * while sleeping are accounted on wakeup, so tasks are woken up on time.
+ * A wakeup by some other interrupt ends the sleep early. With SMP, there is
+ * an idle task per hart, which keeps the tick running and waits for an
+ * interrupt (the tick, or another hart making a task ready).
+ */
+static void idle(void)
+{
+	for (;;) {
+		CRITICAL_ENTER();
+#if NCPU > 1
+		if (kcb->preemptive == 'y' && rq_first(krnl_cpu()) < 0 &&
+		    !rq_steal(krnl_cpu_id()) && !rt_first()) {
+			CRITICAL_LEAVE();
+			_cpu_idle();
+			CRITICAL_ENTER();
+		}
+#else
+		if (kcb->preemptive == 'y' && rq_first(krnl_cpu()) < 0 && !rt_first()) {
+			uint32_t ticks, timer;
+
+			ticks = ilist_empty(&kcb->delay_list) ? TICKLESS_MAX :
+				ilist_entry(kcb->delay_list.next, struct tcb_s, delay_link)->delay;
+			timer = krnl_timer_next();
+			if (timer < ticks)
+				ticks = timer;
+			/* the HAL programs the timer (ticks - 1) periods ahead */
+			if (!ticks)
+				ticks = 1;
+			/* returns the ticks slept, unless the HAL accounted them */
+			ticks = _tickless_sleep(ticks);
+			if (ticks)
+				krnl_tick(ticks);
+		}
+#endif
+		CRITICAL_LEAVE();
+		ucx_task_yield();
+	}
+}
+#endif
+
 
 /* task management API */
 
-int32_t ucx_task_add(void *task, uint16_t stack_size)
+static struct pool_s *tcb_pool;
+
+/*
+ * first code run by a task. a task may be switched in for the first time by
+ * yield(), which runs the scheduler inside a critical section, so leave it
+ * before calling the task function.
+ */
+static void task_start(void)
+{
+	struct tcb_s *task = krnl_cpu()->task_current;
+
+	CRITICAL_LEAVE();
+	task->task();
+}
+
+static struct tcb_s *task_create(void *task, uint16_t stack_size)
 {
 	struct tcb_s *new_tcb;
-	struct node_s *new_task;
 
-	new_tcb = malloc(sizeof(struct tcb_s));
+	new_tcb = ucx_pool_get(&tcb_pool, sizeof(struct tcb_s), TCB_POOL_SIZE) ?
+		ucx_pool_alloc(tcb_pool) : 0;
 		
 	if (!new_tcb)
 		krnl_panic(ERR_TCB_ALLOC);
 
-	CRITICAL_ENTER();
-	
-	new_task = list_pushback(kcb->tasks, new_tcb);
-	
-	if (!new_task)
-		krnl_panic(ERR_TCB_ALLOC);
-	
-	new_task->data = new_tcb;
 	new_tcb->task = task;
 	new_tcb->delay = 0;
 	new_tcb->stack_sz = stack_size;
-	new_tcb->id = kcb->id_next++;
 	new_tcb->state = TASK_STOPPED;
+	new_tcb->cpu = 0;
+	new_tcb->affinity = CPU_MASK_ALL;
 	new_tcb->priority = TASK_NORMAL_PRIO;
+	new_tcb->base_priority = TASK_NORMAL_PRIO;
+	new_tcb->mutex_wait = 0;
+	new_tcb->mutex_held = 0;
+	new_tcb->sem_wait = 0;
+	ilist_init(&new_tcb->mutexes);
+	new_tcb->run_time = 0;
+	new_tcb->run_mark = 0;
+	new_tcb->switches = 0;
+	new_tcb->preemptions = 0;
+	new_tcb->rt_period = 0;
+	new_tcb->rt_misses = 0;
+	ilist_init(&new_tcb->rt_link);
+	new_tcb->period = 0;
+	ilist_init(&new_tcb->delay_link);
+	ilist_init(&new_tcb->wq_link);
 	new_tcb->stack = malloc(stack_size);
 		
 	if (!new_tcb->stack)
 		krnl_panic(ERR_STACK_ALLOC);
 
+	if (task_id_alloc(new_tcb) < 0)
+		krnl_panic(ERR_TCB_ALLOC);
+
+	CRITICAL_ENTER();
+	ilist_pushback(&kcb->tasks, &new_tcb->link);
+	kcb->task_count++;
 	CRITICAL_LEAVE();
 
 	memset(new_tcb->stack, 0x69, stack_size);
 	memset(new_tcb->stack, 0x33, 4);
-	memset((new_tcb->stack) + stack_size - 4, 0x33, 4);
+	memset((char *)new_tcb->stack + stack_size - 4, 0x33, 4);
 	
 	_context_init(&new_tcb->context, (size_t)new_tcb->stack,
-		stack_size, (size_t)task);
+		stack_size, (size_t)task_start);
 
 	printf("task %d: 0x%p, stack: 0x%p, size %d\n", new_tcb->id,
 		new_tcb->task, new_tcb->stack, new_tcb->stack_sz);
 
-	new_tcb->state = TASK_READY;
+	return new_tcb;
+}
+
+#ifdef STACK_REPORT
+/*
+ * kernel task (STACK_REPORT builds) printing the stack report once, STACK_REPORT
+ * ticks after boot, when the application tasks had a chance to reach their
+ * deepest calls. it stays suspended afterwards.
+ */
+static void stack_report(void)
+{
+	ucx_task_delay(STACK_REPORT);
+	ucx_task_stack_report();
+	for (;;)
+		ucx_task_suspend(ucx_task_id());
+}
+#endif
+
+void krnl_idle_init(void)
+{
+#if defined(TICKLESS) || NCPU > 1
+	struct tcb_s *task;
+	uint8_t i;
+
+	for (i = 0; i < NCPU; i++) {
+		task = task_create(idle, DEFAULT_STACK_SIZE);
+		task->cpu = i;
+		task->affinity = (uint32_t)1 << i;
+		kcb->cpu[i].idle = task;
+	}
+#endif
+#ifdef STACK_REPORT
+	ucx_task_add(stack_report, DEFAULT_STACK_SIZE);
+#endif
+}
+
+int32_t ucx_task_add(void *task, uint16_t stack_size)
+{
+	struct tcb_s *new_tcb;
+
+	new_tcb = task_create(task, stack_size);
+
+	CRITICAL_ENTER();
+	krnl_setstate(new_tcb, TASK_READY);
+	CRITICAL_LEAVE();
+
+	return ERR_OK;
+}
+
+/*
+ * adds a real time task. a job is released every period ticks (the first one
+ * now), which may run for capacity ticks and must end (with ucx_task_rt_wait())
+ * within deadline ticks of its release, with capacity <= deadline <= period.
+ * a task is admitted only while the total density (capacity / deadline) of
+ * real time tasks is at most 1, so all deadlines can be met by EDF (on any
+ * number of harts). real time tasks run with TASK_CRIT_PRIO, which is the
+ * priority passed on to mutex owners.
+ */
+int32_t ucx_task_rt_add(void *task, uint16_t stack_size, uint16_t period,
+	uint16_t capacity, uint16_t deadline)
+{
+	struct tcb_s *new_tcb;
+	uint16_t load;
+
+	if (!capacity || capacity > deadline || deadline > period)
+		return ERR_FAIL;
+
+	load = rt_density(capacity, deadline);
+	CRITICAL_ENTER();
+	if (kcb->rt_load + load > 1000) {
+		CRITICAL_LEAVE();
+
+		return ERR_TASK_RT_LOAD;
+	}
+	kcb->rt_load += load;
+	CRITICAL_LEAVE();
+
+	new_tcb = task_create(task, stack_size);
+	new_tcb->priority = TASK_CRIT_PRIO;
+	new_tcb->base_priority = TASK_CRIT_PRIO;
+	new_tcb->rt_period = period;
+	new_tcb->rt_capacity = capacity;
+	new_tcb->rt_deadline = deadline;
+
+	CRITICAL_ENTER();
+	new_tcb->rt_release = kcb->ticks;
+	new_tcb->rt_due = new_tcb->rt_release + deadline;
+	new_tcb->rt_budget = capacity;
+	krnl_setstate(new_tcb, TASK_READY);
+	CRITICAL_LEAVE();
 
 	return ERR_OK;
 }
 
+/*
+ * ends the job of the calling real time task, which sleeps until its next
+ * release. a job that ends after its deadline counts as a miss. other tasks
+ * just yield.
+ */
+void ucx_task_rt_wait(void)
+{
+	struct tcb_s *task;
+
+	CRITICAL_ENTER();
+	task = krnl_cpu()->task_current;
+	if (!task->rt_period) {
+		CRITICAL_LEAVE();
+		ucx_task_yield();
+
+		return;
+	}
+
+	if ((int32_t)(kcb->ticks - task->rt_due) > 0)
+		task->rt_misses++;
+	rt_next(task);
+	if (rt_sleep(task))
+		krnl_yield();
+	CRITICAL_LEAVE();
+}
+
 int32_t ucx_task_remove(uint16_t id)
 {
-	struct node_s *node;
 	struct tcb_s *task;
+	uint8_t i;
 	
-	if (id == ucx_task_id())
-		return ERR_TASK_CANT_REMOVE;
-
 	CRITICAL_ENTER();
-	node = list_foreach(kcb->tasks, idcmp, (void *)(size_t)id);
+	task = task_find(id);
 	
-	if (!node) {
+	if (!task) {
 		CRITICAL_LEAVE();
 		
 		return ERR_TASK_NOT_FOUND;
 	}
+
+	/* the calling task, or a task running on another hart */
+	for (i = 0; i < NCPU; i++) {
+		if (kcb->cpu[i].task_current == task || kcb->cpu[i].idle == task) {
+			CRITICAL_LEAVE();
+
+			return ERR_TASK_CANT_REMOVE;
+		}
+	}
+
+	/* mutexes would be left owned (or waited on) by a freed task */
+	if (task->mutex_held || task->mutex_wait) {
+		CRITICAL_LEAVE();
+
+		return ERR_TASK_CANT_REMOVE;
+	}
 	
-	task = node->data;
-	free(task->stack);
-	free(task);
-	
-	list_remove(kcb->tasks, node);
+	/* a semaphore waiter (not yet woken up) gives back its count */
+	if (task->sem_wait && ilist_linked(&task->wq_link))
+		task->sem_wait->count++;
+	delay_remove(task);
+	ilist_remove(&task->wq_link);
+	krnl_setstate(task, TASK_STOPPED);
+	if (task->rt_period)
+		kcb->rt_load -= rt_density(task->rt_capacity, task->rt_deadline);
+	ilist_remove(&task->link);
+	task_id_free(task->id);
+	kcb->task_count--;
 	CRITICAL_LEAVE();
+
+	/* the allocators have their own critical sections */
+	free(task->stack);
+	ucx_pool_free(tcb_pool, task);
 	
 	return ERR_OK;
 }
@@ -256,56 +1080,131 @@ void ucx_task_delay(uint16_t ticks)		// FIXME: delay any task
 {
 	struct tcb_s *task;
 	
+	if (!ticks) {
+		ucx_task_yield();
+
+		return;
+	}
+
 	CRITICAL_ENTER();
-	task = kcb->task_current->data;
-	task->delay = ticks;
-	task->state = TASK_BLOCKED;
+	task = krnl_cpu()->task_current;
+	delay_insert(task, ticks);
+	krnl_setstate(task, TASK_BLOCKED);
+	krnl_yield();
+	CRITICAL_LEAVE();
+}
+
+/*
+ * delays the current task until *last_wake + period (in absolute ticks), and
+ * moves *last_wake there. a loop calling this wakes up exactly once every
+ * period, no matter how long it runs between calls (as long as it is less
+ * than a period), and tasks with the same wakeup time are woken up together.
+ * *last_wake is set to ucx_ticks() before the first call. ticks are compared
+ * modulo 2^32, so the tick count can wrap. returns ERR_TIMEOUT, without
+ * blocking, if the wakeup time has already passed.
+ */
+int32_t ucx_task_delay_until(uint32_t *last_wake, uint16_t period)
+{
+	struct tcb_s *task;
+	int32_t ticks;
+
+	CRITICAL_ENTER();
+	*last_wake += period;
+	ticks = *last_wake - kcb->ticks;
+	if (ticks <= 0) {
+		CRITICAL_LEAVE();
+		ucx_task_yield();
+
+		return ERR_TIMEOUT;
+	}
+
+	task = krnl_cpu()->task_current;
+	delay_insert(task, ticks);
+	krnl_setstate(task, TASK_BLOCKED);
+	krnl_yield();
+	CRITICAL_LEAVE();
+
+	return ERR_OK;
+}
+
+/*
+ * makes a task periodic, with its first period starting now (0 makes it not
+ * periodic). the task waits for its next period with ucx_task_wait_period().
+ */
+int32_t ucx_task_period(uint16_t id, uint16_t period)
+{
+	struct tcb_s *task;
+
+	CRITICAL_ENTER();
+	task = task_find(id);
+
+	if (!task) {
+		CRITICAL_LEAVE();
+
+		return ERR_TASK_NOT_FOUND;
+	}
+
+	task->period = period;
+	task->wake = kcb->ticks;
 	CRITICAL_LEAVE();
-	ucx_task_yield();
+
+	return ERR_OK;
+}
+
+/*
+ * waits for the next period of the current task (made periodic with
+ * ucx_task_period(), or a real time task). other tasks just yield.
+ */
+void ucx_task_wait_period(void)
+{
+	struct tcb_s *task = krnl_current();
+
+	if (task->rt_period)
+		ucx_task_rt_wait();
+	else if (task->period)
+		ucx_task_delay_until(&task->wake, task->period);
+	else
+		ucx_task_yield();
 }
 
 int32_t ucx_task_suspend(uint16_t id)
 {
-	struct node_s *node;
 	struct tcb_s *task;
 
 	CRITICAL_ENTER();
-	node = list_foreach(kcb->tasks, idcmp, (void *)(size_t)id);
+	task = task_find(id);
 	
-	if (!node) {
+	if (!task) {
 		CRITICAL_LEAVE();
 		
 		return ERR_TASK_NOT_FOUND;
 	}
 
-	task = node->data;
 	if (task->state == TASK_READY || task->state == TASK_RUNNING)
-		task->state = TASK_SUSPENDED;
+		krnl_setstate(task, TASK_SUSPENDED);
+	/* a task running on another hart stops on its next switch */
+	if (krnl_cpu()->task_current == task)
+		krnl_yield();
 	CRITICAL_LEAVE();
-	
-	if (kcb->task_current == node)
-		ucx_task_yield();
 
 	return ERR_OK;
 }
 
 int32_t ucx_task_resume(uint16_t id)
 {
-	struct node_s *node;
 	struct tcb_s *task;
 
 	CRITICAL_ENTER();
-	node = list_foreach(kcb->tasks, idcmp, (void *)(size_t)id);
+	task = task_find(id);
 	
-	if (!node) {
+	if (!task) {
 		CRITICAL_LEAVE();
 		
 		return ERR_TASK_NOT_FOUND;
 	}
 
-	task = node->data;
 	if (task->state == TASK_SUSPENDED)
-		task->state = TASK_READY;
+		krnl_setstate(task, TASK_READY);
 	CRITICAL_LEAVE();
 
 	return ERR_OK;
@@ -313,7 +1212,6 @@ int32_t ucx_task_resume(uint16_t id)
 
 int32_t ucx_task_priority(uint16_t id, uint16_t priority)
 {
-	struct node_s *node;
 	struct tcb_s *task;
 
 	switch (priority) {
@@ -328,16 +1226,60 @@ int32_t ucx_task_priority(uint16_t id, uint16_t priority)
 	}
 
 	CRITICAL_ENTER();
-	node = list_foreach(kcb->tasks, idcmp, (void *)(size_t)id);
+	task = task_find(id);
 	
-	if (!node) {
+	if (!task) {
 		CRITICAL_LEAVE();
 		
 		return ERR_TASK_NOT_FOUND;
 	}
 
-	task = node->data;
-	task->priority = priority;
+	/* a task holding a mutex keeps an inherited priority until it unlocks */
+	task->base_priority = priority;
+	if (ilist_empty(&task->mutexes))
+		krnl_setprio(task, priority);
+	CRITICAL_LEAVE();
+
+	return ERR_OK;
+}
+
+/*
+ * sets the harts a task may run on (bit n for hart n). a ready task is moved
+ * to an allowed hart right away, and a task running on a hart it may no
+ * longer use moves on its next switch (the calling task, immediately).
+ */
+int32_t ucx_task_affinity(uint16_t id, uint32_t mask)
+{
+	struct tcb_s *task;
+
+	mask &= CPU_MASK_ALL;
+	if (!mask)
+		return ERR_FAIL;
+
+	CRITICAL_ENTER();
+	task = task_find(id);
+
+	if (!task) {
+		CRITICAL_LEAVE();
+
+		return ERR_TASK_NOT_FOUND;
+	}
+
+	if (task_idle(task)) {
+		CRITICAL_LEAVE();
+
+		return ERR_FAIL;
+	}
+
+	if (task->state == TASK_READY) {
+		rq_remove(task);
+		task->affinity = mask;
+		rq_insert(task);
+	} else {
+		task->affinity = mask;
+	}
+	if (krnl_cpu()->task_current == task && !(mask & ((uint32_t)1 << krnl_cpu_id())))
+		krnl_yield();
 	CRITICAL_LEAVE();
 
 	return ERR_OK;
@@ -345,7 +1287,7 @@ int32_t ucx_task_priority(uint16_t id, uint16_t priority)
 
 uint16_t ucx_task_id()
 {
-	struct tcb_s *task = kcb->task_current->data;
+	struct tcb_s *task = krnl_current();
 	
 	return task->id;
 }
@@ -360,10 +1302,190 @@ void ucx_task_wfi()
 
 uint16_t ucx_task_count()
 {
-	return kcb->tasks->length;
+	return kcb->task_count;
+}
+
+int32_t ucx_task_stats(uint16_t id, struct task_stats_s *stats)
+{
+	struct tcb_s *task;
+	struct cpu_s *cpu;
+
+	CRITICAL_ENTER();
+	task = task_find(id);
+
+	if (!task) {
+		CRITICAL_LEAVE();
+
+		return ERR_TASK_NOT_FOUND;
+	}
+
+	cpu = &kcb->cpu[task->cpu];
+	stats->run_time = task->run_time;
+	if (task == cpu->task_current)
+		stats->run_time += _read_us() - cpu->run_start;
+	stats->switches = task->switches;
+	stats->preemptions = task->preemptions;
+	stats->misses = task->rt_misses;
+	stats->id = task->id;
+	stats->priority = task->priority;
+	stats->state = task->state;
+	stats->cpu = task->cpu;
+	CRITICAL_LEAVE();
+
+	return ERR_OK;
+}
+
+/*
+ * prints a table of tasks, with the share of the cpu each task had since the
+ * previous call (or since boot), the total run time and the number of
+ * voluntary and involuntary context switches. tasks are looked up by id and
+ * copied inside a critical section, so a task removed meanwhile is skipped,
+ * and printed outside it.
+ */
+void ucx_task_top(void)
+{
+	const char *states[] = {"stopped", "ready", "running", "blocked", "suspended"};
+	struct tcb_s *task;
+	struct cpu_s *cpu;
+	uint64_t now, delta, interval, run_time;
+	uint32_t share, switches, preemptions;
+	uint16_t id, priority;
+	uint8_t i, state, idle;
+	char *prio;
+
+	CRITICAL_ENTER();
+	now = _read_us();
+	for (i = 0; i < NCPU; i++) {
+		cpu = &kcb->cpu[i];
+		if (!cpu->task_current)
+			continue;
+		cpu->task_current->run_time += now - cpu->run_start;
+		cpu->run_start = now;
+	}
+	interval = now - kcb->top_time;
+	kcb->top_time = now;
+	CRITICAL_LEAVE();
+
+	printf("\n  id  state      prio      cpu        time (ms)   switches  preempts\n");
+	for (id = 0; id < kcb->task_ids_max; id++) {
+		CRITICAL_ENTER();
+		task = task_find(id);
+		if (!task) {
+			CRITICAL_LEAVE();
+			continue;
+		}
+		run_time = task->run_time;
+		delta = run_time - task->run_mark;
+		task->run_mark = run_time;
+		switches = task->switches;
+		preemptions = task->preemptions;
+		priority = task->priority;
+		state = task->state;
+		idle = task_idle(task);
+		CRITICAL_LEAVE();
+
+		share = interval ? delta * 1000 / interval : 0;
+		switch (priority) {
+		case TASK_CRIT_PRIO: prio = "crit"; break;
+		case TASK_HIGH_PRIO: prio = "high"; break;
+		case TASK_NORMAL_PRIO: prio = "normal"; break;
+		case TASK_LOW_PRIO: prio = "low"; break;
+		default: prio = "idle";
+		}
+		printf("%4d  %-9s  %-6s  %3d.%d%%  %15llu  %9lu  %8lu%s\n", id,
+			states[state], prio, (int)(share / 10), (int)(share % 10),
+			run_time / 1000, (unsigned long)switches,
+			(unsigned long)preemptions, idle ? "  (idle)" : "");
+	}
+}
+
+/*
+ * stacks grow down and are filled with 0x69 on task creation, so the bytes
+ * still holding the pattern above the bottom canary were never used. the scan
+ * compares bytes up to a word boundary, then whole words (only those that fit
+ * in the stack) and the last, partially used, word byte by byte.
+ */
+static uint16_t stack_used(struct tcb_s *task)
+{
+	uint8_t *b = (uint8_t *)task->stack;
+	uint8_t *top = b + task->stack_sz;
+	uint32_t *p, *end;
+
+	if (b[0] != 0x33 || b[1] != 0x33 || b[2] != 0x33 || b[3] != 0x33)
+		return task->stack_sz;
+
+	for (b += 4; b < top && ((size_t)b & 3) && *b == 0x69; b++);
+	if (!((size_t)b & 3)) {
+		p = (uint32_t *)b;
+		end = (uint32_t *)((size_t)top & ~(size_t)3);
+		while (p < end && *p == 0x69696969)
+			p++;
+		b = (uint8_t *)p;
+	}
+	for (; b < top && *b == 0x69; b++);
+
+	return top - b;
+}
+
+int32_t ucx_task_stack_usage(uint16_t id)
+{
+	struct tcb_s *task;
+	int32_t used;
+
+	CRITICAL_ENTER();
+	task = task_find(id);
+
+	if (!task) {
+		CRITICAL_LEAVE();
+
+		return ERR_TASK_NOT_FOUND;
+	}
+
+	used = stack_used(task);
+	CRITICAL_LEAVE();
+
+	return used;
+}
+
+/* prints the stack usage of all tasks, copied as in ucx_task_top() */
+void ucx_task_stack_report(void)
+{
+	struct tcb_s *task;
+	size_t *stack;
+	uint16_t id, used, total, size;
+
+	printf("\n  id  stack         size    used    free  suggested\n");
+	for (id = 0; id < kcb->task_ids_max; id++) {
+		CRITICAL_ENTER();
+		task = task_find(id);
+		if (!task) {
+			CRITICAL_LEAVE();
+			continue;
+		}
+		used = stack_used(task);
+		total = task->stack_sz;
+		stack = task->stack;
+		CRITICAL_LEAVE();
+
+		/* 25% over the high water mark, rounded up to 16 bytes */
+		size = (used + (used >> 2) + 15) & ~15;
+		printf("%4d  0x%p  %6d  %6d  %6d  %9d%s\n", id, stack,
+			total, used, total - used, size, used >= total ? "  (overflow)" : "");
+	}
 }
 
 uint32_t ucx_ticks()
 {
 	return kcb->ticks;
 }
+
+uint64_t ucx_ticks64(void)
+{
+	uint64_t ticks;
+
+	CRITICAL_ENTER();
+	ticks = ((uint64_t)kcb->ticks_hi << 32) | kcb->ticks;
+	CRITICAL_LEAVE();
+
+	return ticks;
+}
@@ -6,6 +6,15 @@
 
 #include <ucx.h>
 
+/* machine word access, for the word at a time string and memory functions */
+typedef size_t __attribute__((__may_alias__)) word_t;
+
+#define WSIZE		sizeof(word_t)
+#define WMASK		(WSIZE - 1)
+#define WONES		((word_t)-1 / 0xff)
+#define WHIGHS		(WONES << 7)
+#define HASZERO(w)	(((w) - WONES) & ~(w) & WHIGHS)
+
 char *ucx_strcpy(char *s1, const char *s2)
 {
 	char *os1 = s1;
@@ -58,6 +67,72 @@ char *ucx_strncat(char *s1, const char *s2, int32_t n)
 	return os1;
 }
 
+/*
+ * with WORD_STRINGS, strcmp(), strncmp(), strlen() and strchr() scan strings
+ * a word at a time after an alignment prologue. a word holds a zero byte if
+ * HASZERO() is not zero (the borrow of subtracting 0x01 from each byte only
+ * reaches the high bit of a byte that was zero, or of a byte past it). words
+ * are read at aligned addresses only, so a read never crosses into the next
+ * page or memory region, though it may read a few bytes past the string end.
+ * two strings are compared by words only if they are equally aligned.
+ */
+#ifdef WORD_STRINGS
+int32_t ucx_strcmp(const char *s1, const char *s2)
+{
+	const word_t *w1, *w2;
+
+	if (!(((size_t)s1 ^ (size_t)s2) & WMASK)) {
+		for (; (size_t)s1 & WMASK; s1++, s2++)
+			if (*s1 != *s2 || !*s1)
+				return *s1 - *s2;
+
+		w1 = (const word_t *)s1;
+		w2 = (const word_t *)s2;
+		while (*w1 == *w2 && !HASZERO(*w1)) {
+			w1++;
+			w2++;
+		}
+		s1 = (const char *)w1;
+		s2 = (const char *)w2;
+	}
+
+	while (*s1 == *s2++)
+		if (*s1++ == '\0')
+			return 0;
+
+	return (*s1 - *--s2);
+}
+
+int32_t ucx_strncmp(const char *s1, const char *s2, int32_t n)
+{
+	const word_t *w1, *w2;
+
+	if (!(((size_t)s1 ^ (size_t)s2) & WMASK)) {
+		for (; (size_t)s1 & WMASK; s1++, s2++, n--) {
+			if (n <= 0)
+				return 0;
+			if (*s1 != *s2 || !*s1)
+				return *s1 - *s2;
+		}
+
+		w1 = (const word_t *)s1;
+		w2 = (const word_t *)s2;
+		while (n >= (int32_t)WSIZE && *w1 == *w2 && !HASZERO(*w1)) {
+			w1++;
+			w2++;
+			n -= WSIZE;
+		}
+		s1 = (const char *)w1;
+		s2 = (const char *)w2;
+	}
+
+	while (--n >= 0 && *s1 == *s2++)
+		if (*s1++ == '\0')
+			return 0;
+
+	return (n < 0 ? 0 : *s1 - *--s2);
+}
+#else
 int32_t ucx_strcmp(const char *s1, const char *s2)
 {
 	while (*s1 == *s2++)
@@ -75,6 +150,7 @@ int32_t ucx_strncmp(const char *s1, const char *s2, int32_t n)
 
 	return (n < 0 ? 0 : *s1 - *--s2);
 }
+#endif
 
 char *ucx_strstr(const char *s1, const char *s2)
 {
@@ -90,6 +166,45 @@ char *ucx_strstr(const char *s1, const char *s2)
 	}
 }
 
+#ifdef WORD_STRINGS
+int32_t ucx_strlen(const char *s1)
+{
+	const char *s = s1;
+	const word_t *w;
+
+	for (; (size_t)s & WMASK; s++)
+		if (!*s)
+			return s - s1;
+
+	for (w = (const word_t *)s; !HASZERO(*w); w++);
+	for (s = (const char *)w; *s; s++);
+
+	return s - s1;
+}
+
+char *ucx_strchr(const char *s1, int32_t c)
+{
+	const word_t *w;
+	word_t mask;
+
+	for (; (size_t)s1 & WMASK; s1++) {
+		if (*s1 == (char)c)
+			return (char *)s1;
+		if (!*s1)
+			return 0;
+	}
+
+	/* c, replicated on all bytes of a word */
+	mask = WONES * (unsigned char)c;
+	for (w = (const word_t *)s1; !HASZERO(*w) && !HASZERO(*w ^ mask); w++);
+
+	for (s1 = (const char *)w; *s1 != (char)c; s1++)
+		if (!*s1)
+			return 0;
+
+	return (char *)s1;
+}
+#else
 int32_t ucx_strlen(const char *s1)
 {
 	int32_t n;
@@ -109,6 +224,7 @@ char *ucx_strchr(const char *s1, int32_t c)
 
 	return (char *)s1;
 }
+#endif
 
 char *ucx_strpbrk(const char *s1, const char *s2)
 {
@@ -289,39 +405,115 @@ void ucx_itoa(int32_t i, char *s, int32_t base)
 	}
 }
 
+/*
+ * memory functions move whole machine words once the pointers are word aligned,
+ * in unrolled blocks of four words, with byte loops for the unaligned head and
+ * the tail. words are only accessed at aligned addresses, so these are safe on
+ * processors that trap on unaligned accesses (or code built with -mstrict-align).
+ * when source and destination are not equally aligned, bytes are moved. a port
+ * may provide its own (assembly) versions, defining ARCH_MEMCPY, ARCH_MEMMOVE,
+ * ARCH_MEMCMP or ARCH_MEMSET in its arch.mak.
+ */
+
+#ifndef ARCH_MEMCPY
 void *ucx_memcpy(void *dst, const void *src, uint32_t n)
 {
 	char *r1 = dst;
 	const char *r2 = src;
+	word_t *w1;
+	const word_t *w2;
+
+	if (n >= WSIZE && !(((size_t)r1 ^ (size_t)r2) & WMASK)) {
+		for (; (size_t)r1 & WMASK; n--)
+			*r1++ = *r2++;
+
+		w1 = (word_t *)r1;
+		w2 = (const word_t *)r2;
+		for (; n >= 4 * WSIZE; n -= 4 * WSIZE) {
+			w1[0] = w2[0];
+			w1[1] = w2[1];
+			w1[2] = w2[2];
+			w1[3] = w2[3];
+			w1 += 4;
+			w2 += 4;
+		}
+		for (; n >= WSIZE; n -= WSIZE)
+			*w1++ = *w2++;
+		r1 = (char *)w1;
+		r2 = (const char *)w2;
+	}
 
 	while (n--)
 		*r1++ = *r2++;
 
 	return dst;
 }
+#endif
 
+#ifndef ARCH_MEMMOVE
 void *ucx_memmove(void *dst, const void *src, uint32_t n)
 {
 	char *s = (char *)dst;
-	char *p = (char *)src;
-
-	if (p >= s) {
-		while (n--)
-			*s++ = *p++;
-	} else {
-		s += n;
-		p += n;
-		while (n--)
+	const char *p = (const char *)src;
+	word_t *w1;
+	const word_t *w2;
+
+	/* a forward copy is safe unless the destination overlaps the source end */
+	if (s <= p || s >= p + n)
+		return ucx_memcpy(dst, src, n);
+
+	s += n;
+	p += n;
+	if (n >= WSIZE && !(((size_t)s ^ (size_t)p) & WMASK)) {
+		for (; (size_t)s & WMASK; n--)
 			*--s = *--p;
+
+		w1 = (word_t *)s;
+		w2 = (const word_t *)p;
+		for (; n >= 4 * WSIZE; n -= 4 * WSIZE) {
+			w1 -= 4;
+			w2 -= 4;
+			w1[3] = w2[3];
+			w1[2] = w2[2];
+			w1[1] = w2[1];
+			w1[0] = w2[0];
+		}
+		for (; n >= WSIZE; n -= WSIZE)
+			*--w1 = *--w2;
+		s = (char *)w1;
+		p = (const char *)w2;
 	}
 
+	while (n--)
+		*--s = *--p;
+
 	return dst;
 }
+#endif
 
+#ifndef ARCH_MEMCMP
 int32_t ucx_memcmp(const void *cs, const void *ct, uint32_t n)
 {
-	char *r1 = (char *)cs;
-	char *r2 = (char *)ct;
+	const unsigned char *r1 = (const unsigned char *)cs;
+	const unsigned char *r2 = (const unsigned char *)ct;
+	const word_t *w1, *w2;
+
+	if (n >= WSIZE && !(((size_t)r1 ^ (size_t)r2) & WMASK)) {
+		for (; (size_t)r1 & WMASK; n--, r1++, r2++)
+			if (*r1 != *r2)
+				return (*r1 < *r2) ? -1 : 1;
+
+		/* skip equal words, the first difference is found bytewise */
+		w1 = (const word_t *)r1;
+		w2 = (const word_t *)r2;
+		for (; n >= 4 * WSIZE; n -= 4 * WSIZE, w1 += 4, w2 += 4)
+			if ((w1[0] ^ w2[0]) | (w1[1] ^ w2[1]) | (w1[2] ^ w2[2]) | (w1[3] ^ w2[3]))
+				break;
+		for (; n >= WSIZE && *w1 == *w2; n -= WSIZE)
+			w1++, w2++;
+		r1 = (const unsigned char *)w1;
+		r2 = (const unsigned char *)w2;
+	}
 
 	while (n && (*r1 == *r2)) {
 		++r1;
@@ -331,16 +523,39 @@ int32_t ucx_memcmp(const void *cs, const void *ct, uint32_t n)
 
 	return (n == 0) ? 0 : ((*r1 < *r2) ? -1 : 1);
 }
+#endif
 
+#ifndef ARCH_MEMSET
 void *ucx_memset(void *s, int32_t c, uint32_t n)
 {
 	char *p = (char *)s;
+	word_t *w, v;
+
+	if (n >= WSIZE) {
+		for (; (size_t)p & WMASK; n--)
+			*p++ = (char)c;
+
+		/* the byte, replicated on all bytes of a word */
+		v = (word_t)-1 / 0xff * (unsigned char)c;
+		w = (word_t *)p;
+		for (; n >= 4 * WSIZE; n -= 4 * WSIZE) {
+			w[0] = v;
+			w[1] = v;
+			w[2] = v;
+			w[3] = v;
+			w += 4;
+		}
+		for (; n >= WSIZE; n -= WSIZE)
+			*w++ = v;
+		p = (char *)w;
+	}
 
 	while (n--)
 		*p++ = (char)c;
 
 	return s;
 }
+#endif
 
 int32_t ucx_abs(int32_t n)
 {
@@ -426,14 +641,46 @@ char *ucx_getline(char *s)
 
 /* printf() / sprintf() stuff */
 
-static uint32_t divide(long *n, int base)
-{
-	uint32_t res;
+/*
+ * formatted output, with the %c, %s, %d, %i, %u, %x, %X, %o, %p, %f, %k
+ * (fixed_t) and %% conversions, the '-', '+', ' ' and '0' flags, width and
+ * precision (also given as '*') and the hh, h, l, ll and z length modifiers.
+ * as in earlier versions, %x takes a long (printed as 32 bits) when no length
+ * is given. numbers are converted to decimal by subtracting powers of ten and
+ * fractions by multiplying by ten, so no division is needed (most supported
+ * processors have no divider, or no 64 bit one). %f and %k print up to
+ * FMT_PREC_MAX fraction digits, and %f prints values up to 2^64.
+ */
 
-	res = ((uint32_t)*n) % base;
-	*n = (long)(((uint32_t)*n) / base);
-	return res;
-}
+#ifndef FIX_IBITS
+#define FIX_IBITS		16
+#endif
+
+#define FMT_LEFT		0x01
+#define FMT_ZERO		0x02
+#define FMT_PLUS		0x04
+#define FMT_SPACE		0x08
+#define FMT_PREC_MAX		19
+#define FMT_FRAC_BITS		60		/* binary point of fractions */
+
+struct fmt_out_s {
+	char *buf;				/* null: console */
+	size_t size;
+	size_t len;
+};
+
+static const uint32_t pow10_32[] = {
+	1000000000, 100000000, 10000000, 1000000, 100000,
+	10000, 1000, 100, 10, 1
+};
+
+static const uint64_t pow10_64[] = {
+	10000000000000000000ULL, 1000000000000000000ULL, 100000000000000000ULL,
+	10000000000000000ULL, 1000000000000000ULL, 100000000000000ULL,
+	10000000000000ULL, 1000000000000ULL, 100000000000ULL, 10000000000ULL,
+	1000000000ULL, 100000000ULL, 10000000ULL, 1000000ULL, 100000ULL,
+	10000ULL, 1000ULL, 100ULL, 10ULL, 1ULL
+};
 
 static int toint(const char **s)
 {
@@ -444,118 +691,381 @@ static int toint(const char **s)
 	return i;
 }
 
-static void printchar(char **str, int32_t c){
-	if (str) {
-		**str = c;
-		++(*str);
+static void fmt_putc(struct fmt_out_s *o, char c)
+{
+	if (!o->buf)
+		_putchar(c);
+	else if (o->len + 1 < o->size)
+		o->buf[o->len] = c;
+	o->len++;
+}
+
+static int32_t fmt_dec(char *s, uint64_t v)
+{
+	int32_t i, n = 0;
+	uint32_t v32;
+	char d;
+
+	if (v >> 32) {
+		for (i = 0; i < 20; i++) {
+			for (d = '0'; v >= pow10_64[i]; d++)
+				v -= pow10_64[i];
+			if (d != '0' || n)
+				s[n++] = d;
+		}
+
+		return n;
+	}
+
+	v32 = v;
+	for (i = 0; i < 10; i++) {
+		for (d = '0'; v32 >= pow10_32[i]; d++)
+			v32 -= pow10_32[i];
+		if (d != '0' || n)
+			s[n++] = d;
+	}
+	if (!n)
+		s[n++] = '0';
+
+	return n;
+}
+
+/* hexadecimal (shift 4) or octal (shift 3) */
+static int32_t fmt_pow2(char *s, uint64_t v, int32_t shift, char upper)
+{
+	const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+	int32_t i, n = 0;
+	char c;
+
+	do {
+		s[n++] = digits[v & ((1 << shift) - 1)];
+		v >>= shift;
+	} while (v);
+
+	for (i = 0; i < n / 2; i++) {
+		c = s[i];
+		s[i] = s[n - 1 - i];
+		s[n - 1 - i] = c;
+	}
+
+	return n;
+}
+
+/*
+ * integer part and fraction digits of a number, with the fraction as a binary
+ * fixed point value (FMT_FRAC_BITS). the last digit is rounded (half up).
+ */
+static int32_t fmt_fixed(char *s, uint64_t ip, uint64_t frac, int32_t prec)
+{
+	const uint64_t mask = ((uint64_t)1 << FMT_FRAC_BITS) - 1;
+	char f[FMT_PREC_MAX];
+	int32_t i, k, n;
+
+	if (prec > FMT_PREC_MAX)
+		prec = FMT_PREC_MAX;
+
+	for (i = 0; i < prec; i++) {
+		frac = (frac << 3) + (frac << 1);
+		f[i] = '0' + (frac >> FMT_FRAC_BITS);
+		frac &= mask;
+	}
+	frac = (frac << 3) + (frac << 1);
+	if ((frac >> FMT_FRAC_BITS) >= 5) {
+		for (k = prec - 1; k >= 0 && f[k] == '9'; k--)
+			f[k] = '0';
+		if (k >= 0)
+			f[k]++;
+		else
+			ip++;
+	}
+
+	n = fmt_dec(s, ip);
+	if (prec) {
+		s[n++] = '.';
+		for (i = 0; i < prec; i++)
+			s[n++] = f[i];
+	}
+
+	return n;
+}
+
+/* splits a double in its integer part and fraction, returns -1 for inf, -2 for nan */
+static int32_t fmt_double(double val, int32_t *neg, uint64_t *ip, uint64_t *frac)
+{
+	union {
+		double d;
+		uint64_t u;
+		uint32_t w;
+	} fv;
+	uint64_t mant;
+	int32_t e, exp;
+
+	fv.d = val;
+	if (sizeof(double) == 4) {
+		*neg = fv.w >> 31;
+		exp = (fv.w >> 23) & 0xff;
+		mant = (uint64_t)(fv.w & 0x7fffff) << 29;
+		if (exp == 0xff)
+			return mant ? -2 : -1;
+		e = exp ? exp - 127 : -126;
+	} else {
+		*neg = fv.u >> 63;
+		exp = (fv.u >> 52) & 0x7ff;
+		mant = fv.u & (((uint64_t)1 << 52) - 1);
+		if (exp == 0x7ff)
+			return mant ? -2 : -1;
+		e = exp ? exp - 1023 : -1022;
+	}
+	if (exp)
+		mant |= (uint64_t)1 << 52;
+
+	/* val = mant * 2^(e - 52) */
+	if (e >= 64) {
+		*ip = (uint64_t)-1;
+		*frac = 0;
+	} else if (e >= 52) {
+		*ip = mant << (e - 52);
+		*frac = 0;
+	} else if (e >= 0) {
+		*ip = mant >> (52 - e);
+		*frac = (mant & (((uint64_t)1 << (52 - e)) - 1)) << (FMT_FRAC_BITS - 52 + e);
 	} else {
-		if (c) _putchar(c);
+		*ip = 0;
+		e += FMT_FRAC_BITS - 52;
+		if (e >= 0)
+			*frac = mant << e;
+		else
+			*frac = e > -64 ? mant >> -e : 0;
 	}
+
+	return 0;
 }
 
-static int ucx_vsprintf(char **buf, const char *fmt, va_list args)
+static void fmt_field(struct fmt_out_s *o, char sign, const char *body, int32_t len,
+	int32_t zeros, int32_t width, int32_t flags)
 {
-	char **p, *str;
-	const char *digits = "0123456789abcdef";
-	char pad, tmp[16];
-	int width, base, sign, i;
-	long num;
+	int32_t pad;
+
+	pad = width - len - zeros - (sign ? 1 : 0);
+	if (!(flags & (FMT_LEFT | FMT_ZERO)))
+		for (; pad > 0; pad--)
+			fmt_putc(o, ' ');
+	if (sign)
+		fmt_putc(o, sign);
+	if ((flags & (FMT_LEFT | FMT_ZERO)) == FMT_ZERO)
+		for (; pad > 0; pad--)
+			fmt_putc(o, '0');
+	for (; zeros > 0; zeros--)
+		fmt_putc(o, '0');
+	for (; len > 0; len--)
+		fmt_putc(o, *body++);
+	for (; pad > 0; pad--)
+		fmt_putc(o, ' ');
+}
 
-	for (p = buf; *fmt; fmt++) {
+static int32_t fmt_vformat(struct fmt_out_s *o, const char *fmt, va_list args)
+{
+	char tmp[48], sign;
+	const char *str;
+	int32_t flags, width, prec, lmod, len, neg;
+	uint64_t v, frac;
+	uint32_t fx;
+
+	for (; *fmt; fmt++) {
 		if (*fmt != '%') {
-			printchar(p, *fmt);
+			fmt_putc(o, *fmt);
 			continue;
 		}
-		/* get flags */
-		++fmt;
-		pad = ' ';
-		if (*fmt == '0') {
-			pad = '0';
-			fmt++;
+
+		/* flags, width, precision and length */
+		for (flags = 0;; ) {
+			switch (*++fmt) {
+			case '-': flags |= FMT_LEFT; continue;
+			case '0': flags |= FMT_ZERO; continue;
+			case '+': flags |= FMT_PLUS; continue;
+			case ' ': flags |= FMT_SPACE; continue;
+			}
+			break;
 		}
-		/* get width */
-		width = -1;
-		if (isdigit(*fmt)) {
+		if (*fmt == '*') {
+			width = va_arg(args, int);
+			if (width < 0) {
+				flags |= FMT_LEFT;
+				width = -width;
+			}
+			fmt++;
+		} else {
 			width = toint(&fmt);
 		}
-		base = 10;
-		sign = 0;
+		prec = -1;
+		if (*fmt == '.') {
+			if (*++fmt == '*') {
+				prec = va_arg(args, int);
+				fmt++;
+			} else {
+				prec = toint(&fmt);
+			}
+		}
+		for (lmod = 0; *fmt == 'h' || *fmt == 'l' || *fmt == 'z'; fmt++)
+			lmod += *fmt == 'h' ? -1 : *fmt == 'l' ? 1 : 3;
+
+		neg = 0;
 		switch (*fmt) {
+		case '\0':
+			fmt--;
+			continue;
+		case '%':
+			fmt_putc(o, '%');
+			continue;
 		case 'c':
-			printchar(p, (char)va_arg(args, int));
+			tmp[0] = (char)va_arg(args, int);
+			fmt_field(o, 0, tmp, 1, 0, width, flags & FMT_LEFT);
 			continue;
 		case 's':
 			str = va_arg(args, char *);
 			if (str == 0)
 				str = "<NULL>";
-			for (; *str && width != 0; str++, width--) {
-				printchar(p, *str);
-			}
-			while (width-- > 0)
-				printchar(p, pad);
+			for (len = 0; str[len] && (prec < 0 || len < prec); len++);
+			fmt_field(o, 0, str, len, 0, width, flags & FMT_LEFT);
 			continue;
-		case 'l':
-			fmt++;
-			num = va_arg(args, long);
+		case 'f':
+		case 'F':
+			len = fmt_double(va_arg(args, double), &neg, &v, &frac);
+			if (len < 0) {
+				fmt_field(o, neg ? '-' : 0, len == -1 ? "inf" : "nan", 3, 0, width, flags & FMT_LEFT);
+				continue;
+			}
+			len = fmt_fixed(tmp, v, frac, prec < 0 ? 6 : prec);
 			break;
-		case 'X':
-		case 'x':
-			base = 16;
-			num = va_arg(args, long);
+		case 'k':
+			fx = va_arg(args, int32_t);	/* fixed_t */
+			if ((int32_t)fx < 0) {
+				neg = 1;
+				fx = -fx;
+			}
+			len = fmt_fixed(tmp, fx >> (32 - FIX_IBITS),
+				(uint64_t)(fx & (((uint32_t)1 << (32 - FIX_IBITS)) - 1)) << (FMT_FRAC_BITS - 32 + FIX_IBITS),
+				prec < 0 ? 6 : prec);
+			break;
+		case 'p':
+			v = (size_t)va_arg(args, void *);
+			prec = sizeof(void *) * 2;
+			len = fmt_pow2(tmp, v, 4, 0);
 			break;
 		case 'd':
-			sign = 1;
+		case 'i':
 		case 'u':
-			num = va_arg(args, int);
-			break;
-		case 'p':
-			base = 16;
-			num = va_arg(args, size_t);
-			width = sizeof(size_t);
+		case 'x':
+		case 'X':
+		case 'o':
+			if (*fmt == 'd' || *fmt == 'i') {
+				if (lmod >= 3)
+					v = (int64_t)(long)va_arg(args, size_t);
+				else if (lmod == 2)
+					v = va_arg(args, long long);
+				else if (lmod == 1)
+					v = (int64_t)va_arg(args, long);
+				else
+					v = (int64_t)va_arg(args, int);
+				if (lmod == -1)
+					v = (int64_t)(short)v;
+				if (lmod <= -2)
+					v = (int64_t)(signed char)v;
+				if ((int64_t)v < 0) {
+					neg = 1;
+					v = -v;
+				}
+			} else {
+				if (lmod >= 3)
+					v = va_arg(args, size_t);
+				else if (lmod == 2)
+					v = va_arg(args, unsigned long long);
+				else if (lmod == 1 || (lmod == 0 && (*fmt == 'x' || *fmt == 'X')))
+					v = va_arg(args, unsigned long);
+				else
+					v = va_arg(args, unsigned int);
+				if (lmod == 0 && (*fmt == 'x' || *fmt == 'X'))
+					v = (uint32_t)v;
+				if (lmod == -1)
+					v = (unsigned short)v;
+				if (lmod <= -2)
+					v = (unsigned char)v;
+			}
+			if (prec == 0 && v == 0)
+				len = 0;
+			else if (*fmt == 'x' || *fmt == 'X')
+				len = fmt_pow2(tmp, v, 4, *fmt == 'X');
+			else if (*fmt == 'o')
+				len = fmt_pow2(tmp, v, 3, 0);
+			else
+				len = fmt_dec(tmp, v);
 			break;
 		default:
 			continue;
 		}
-		if (sign && num < 0) {
-			num = -num;
-			printchar(p, '-');
-			width--;
+
+		/* numbers */
+		sign = neg ? '-' : (flags & FMT_PLUS) ? '+' : (flags & FMT_SPACE) ? ' ' : 0;
+		if (*fmt == 'f' || *fmt == 'F' || *fmt == 'k') {
+			fmt_field(o, sign, tmp, len, 0, width, flags);
+		} else {
+			if (*fmt == 'u' || *fmt == 'x' || *fmt == 'X' || *fmt == 'o' || *fmt == 'p')
+				sign = 0;
+			if (prec >= 0)
+				flags &= ~FMT_ZERO;
+			fmt_field(o, sign, tmp, len, prec > len ? prec - len : 0, width, flags);
 		}
-		i = 0;
-		if (num == 0)
-			tmp[i++] = '0';
-		else
-			while (num != 0)
-				tmp[i++] = digits[divide(&num, base)];
-		width -= i;
-		while (width-- > 0)
-			printchar(p, pad);
-		while (i-- > 0)
-			printchar(p, tmp[i]);
 	}
-	printchar(p, '\0');
+	if (o->buf && o->size)
+		o->buf[o->len < o->size ? o->len : o->size - 1] = '\0';
 
-	return 0;
+	return o->len;
 }
 
 int32_t ucx_printf(const char *fmt, ...)
 {
+	struct fmt_out_s o = {0, 0, 0};
 	va_list args;
 	int32_t v;
 
 	va_start(args, fmt);
-	v = ucx_vsprintf(0, fmt, args);
+	v = fmt_vformat(&o, fmt, args);
 	va_end(args);
 	return v;
 }
 
 int32_t ucx_sprintf(char *out, const char *fmt, ...)
 {
+	struct fmt_out_s o = {out, (size_t)-1, 0};
 	va_list args;
 	int32_t v;
 
 	va_start(args, fmt);
-	v = ucx_vsprintf(&out, fmt, args);
+	v = fmt_vformat(&o, fmt, args);
 	va_end(args);
 	return v;
 }
+
+/*
+ * at most size - 1 characters are stored, and the output is always null
+ * terminated (if size is not zero). returns the length the output would
+ * have without the limit.
+ */
+int32_t ucx_snprintf(char *out, size_t size, const char *fmt, ...)
+{
+	struct fmt_out_s o = {out, size, 0};
+	va_list args;
+	int32_t v;
+
+	va_start(args, fmt);
+	v = fmt_vformat(&o, fmt, args);
+	va_end(args);
+	return v;
+}
+
+int32_t ucx_vsnprintf(char *out, size_t size, const char *fmt, va_list args)
+{
+	struct fmt_out_s o = {out, size, 0};
+
+	return fmt_vformat(&o, fmt, args);
+}
@@ -6,6 +6,24 @@
 
 #include <ucx.h>
 
+/* list nodes (and sentinels) come from object pools, one for each node type */
+static struct pool_s *node_pool, *dnode_pool;
+
+static struct node_s *node_alloc(void)
+{
+	if (!ucx_pool_get(&node_pool, sizeof(struct node_s), NODE_POOL_SIZE))
+		return 0;
+
+	return ucx_pool_alloc(node_pool);
+}
+
+static struct dnode_s *dnode_alloc(void)
+{
+	if (!ucx_pool_get(&dnode_pool, sizeof(struct dnode_s), NODE_POOL_SIZE))
+		return 0;
+
+	return ucx_pool_alloc(dnode_pool);
+}
 
 /* singly linked list */
 
@@ -19,7 +37,7 @@ struct list_s *list_create()
 	if (!list)
 		return 0;
 	
-	head = malloc(sizeof(struct node_s));
+	head = node_alloc();
 	
 	if (!head) {
 		free(list);
@@ -27,11 +45,11 @@ struct list_s *list_create()
 		return 0;
 	}
 		
-	tail = malloc(sizeof(struct node_s));
+	tail = node_alloc();
 	
 	if (!tail) {
 		free(list);
-		free(head);
+		ucx_pool_free(node_pool, head);
 		
 		return 0;
 	}
@@ -53,8 +71,8 @@ int list_destroy(struct list_s *list)
 	if (list->head->next != list->tail)
 		return -1;
 		
-	free(list->tail);
-	free(list->head);
+	ucx_pool_free(node_pool, list->tail);
+	ucx_pool_free(node_pool, list->head);
 	free(list);
 	
 	return 0;
@@ -64,7 +82,7 @@ struct node_s *list_push(struct list_s *list, void *val)
 {
 	struct node_s *node;
 	
-	node = malloc(sizeof(struct node_s));
+	node = node_alloc();
 	
 	if (!node)
 		return 0;
@@ -82,7 +100,7 @@ struct node_s *list_pushback(struct list_s *list, void *val)
 	struct node_s *node;
 	struct node_s *last;
 	
-	node = malloc(sizeof(struct node_s));
+	node = node_alloc();
 	
 	if (!node)
 		return 0;
@@ -112,7 +130,7 @@ void *list_pop(struct list_s *list)
 	list->head->next = node->next;
 	list->length--;
 	
-	free(node);
+	ucx_pool_free(node_pool, node);
 	
 	return val;
 }
@@ -136,7 +154,7 @@ void *list_popback(struct list_s *list)
 	last->next = list->tail;
 	list->length--;
 	
-	free(node);
+	ucx_pool_free(node_pool, node);
 	
 	return val;
 }
@@ -145,7 +163,7 @@ struct node_s *list_insert(struct list_s *list, struct node_s *prevnode, void *v
 {
 	struct node_s *node;
 	
-	node = malloc(sizeof(struct node_s));
+	node = node_alloc();
 	
 	if (!node)
 		return 0;
@@ -156,7 +174,7 @@ struct node_s *list_insert(struct list_s *list, struct node_s *prevnode, void *v
 	if (prevnode->next) {
 		prevnode->next = node;
 	} else {
-		free(node);
+		ucx_pool_free(node_pool, node);
 		
 		return 0;
 	}
@@ -182,7 +200,7 @@ struct node_s *list_remove(struct list_s *list, struct node_s *node)
 	
 	last->next = node->next;
 	list->length--;
-	free(node);
+	ucx_pool_free(node_pool, node);
 	
 	return val;
 }
@@ -233,7 +251,7 @@ struct dlist_s *dlist_create()
 	if (!list)
 		return 0;
 	
-	head = malloc(sizeof(struct dnode_s));
+	head = dnode_alloc();
 	
 	if (!head) {
 		free(list);
@@ -241,11 +259,11 @@ struct dlist_s *dlist_create()
 		return 0;
 	}
 		
-	tail = malloc(sizeof(struct dnode_s));
+	tail = dnode_alloc();
 	
 	if (!tail) {
 		free(list);
-		free(head);
+		ucx_pool_free(dnode_pool, head);
 		
 		return 0;
 	}
@@ -269,8 +287,8 @@ int dlist_destroy(struct dlist_s *list)
 	if (list->head->next != list->tail)
 		return -1;
 		
-	free(list->tail);
-	free(list->head);
+	ucx_pool_free(dnode_pool, list->tail);
+	ucx_pool_free(dnode_pool, list->head);
 	free(list);
 	
 	return 0;
@@ -280,7 +298,7 @@ struct dnode_s *dlist_push(struct dlist_s *list, void *val)
 {
 	struct dnode_s *node;
 	
-	node = malloc(sizeof(struct dnode_s));
+	node = dnode_alloc();
 	
 	if (!node)
 		return 0;
@@ -299,7 +317,7 @@ struct dnode_s *dlist_pushback(struct dlist_s *list, void *val)
 {
 	struct dnode_s *node;
 	
-	node = malloc(sizeof(struct dnode_s));
+	node = dnode_alloc();
 	
 	if (!node)
 		return 0;
@@ -329,7 +347,7 @@ void *dlist_pop(struct dlist_s *list)
 	list->head->next = node->next;
 	list->length--;
 	
-	free(node);
+	ucx_pool_free(dnode_pool, node);
 	
 	return val;
 }
@@ -349,7 +367,7 @@ void *dlist_popback(struct dlist_s *list)
 	list->tail->prev = node->prev;
 	list->length--;
 	
-	free(node);
+	ucx_pool_free(dnode_pool, node);
 	
 	return val;
 }
@@ -358,7 +376,7 @@ struct dnode_s *dlist_insert(struct dlist_s *list, struct dnode_s *prevnode, voi
 {
 	struct dnode_s *node;
 	
-	node = malloc(sizeof(struct dnode_s));
+	node = dnode_alloc();
 	
 	if (!node)
 		return 0;
@@ -371,7 +389,7 @@ struct dnode_s *dlist_insert(struct dlist_s *list, struct dnode_s *prevnode, voi
 		prevnode->next->prev = node;
 		prevnode->next = node;
 	} else {
-		free(node);
+		ucx_pool_free(dnode_pool, node);
 		
 		return 0;
 	}
@@ -392,7 +410,7 @@ struct dnode_s *dlist_remove(struct dlist_s *list, struct dnode_s *node)
 	node->prev->next = node->next;
 	node->next->prev = node->prev;
 	list->length--;
-	free(node);
+	ucx_pool_free(dnode_pool, node);
 	
 	return val;
 }
@@ -431,3 +449,50 @@ struct dnode_s *dlist_foreach(struct dlist_s *list, struct dnode_s *(*iter_fn)(s
 	
 	return 0;
 }
+
+
+/* intrusive doubly linked list */
+
+void ilist_init(struct ilist_s *list)
+{
+	list->next = list;
+	list->prev = list;
+}
+
+/* inserts link after list (at the front, if list is a list head) */
+void ilist_push(struct ilist_s *list, struct ilist_s *link)
+{
+	link->next = list->next;
+	link->prev = list;
+	list->next->prev = link;
+	list->next = link;
+}
+
+/* inserts link before list (at the back, if list is a list head) */
+void ilist_pushback(struct ilist_s *list, struct ilist_s *link)
+{
+	link->next = list;
+	link->prev = list->prev;
+	list->prev->next = link;
+	list->prev = link;
+}
+
+void ilist_remove(struct ilist_s *link)
+{
+	link->prev->next = link->next;
+	link->next->prev = link->prev;
+	link->next = link;
+	link->prev = link;
+}
+
+struct ilist_s *ilist_pop(struct ilist_s *list)
+{
+	struct ilist_s *link = list->next;
+	
+	if (link == list)
+		return 0;
+	
+	ilist_remove(link);
+	
+	return link;
+}
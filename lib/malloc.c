@@ -1,7 +1,7 @@
 /* file:          malloc.c
- * description:   memory allocator and heap management
+ * description:   memory allocators and heap management
  * 
- * memory allocator using first-fit
+ * memory allocators using first-fit or TLSF
  * 
  * date:          04/2021
  * author:        Sergio Johann Filho <sergio.johann@acad.pucrs.br>
@@ -26,6 +26,7 @@ void ucx_free(void *ptr)
 	struct mem_block_s *p, *q;
 	
 	CRITICAL_ENTER();
+	krnl_trace(TRACE_FREE, ptr);
 	p = ((struct mem_block_s *)ptr) - 1;
 	p->size &= ~1L;
 
@@ -56,6 +57,7 @@ void *ucx_malloc(uint32_t size)
 	
 	size = align4(size);
 	CRITICAL_ENTER();
+	krnl_trace(TRACE_MALLOC, size);
 	p = ff;
 	while (p->size < size + sizeof(struct mem_block_s) || p->size & 1) {
 		if (!p->next && p->size < size) {
@@ -95,10 +97,270 @@ void ucx_heap_init(size_t *zone, uint32_t len)
 	pheap = (struct mem_block_s *)heap;
 }
 
+#elif defined(TLSF_ALLOCATOR)
+/*
+ * memory allocator using TLSF (two-level segregated fit)
+ * 
+ * free blocks are kept in segregated lists, indexed by a first level (power
+ * of 2 size class) and a second level (TLSF_SL_COUNT linear subdivisions of
+ * each class). two levels of bitmaps tell which lists are not empty, so a
+ * suitable free block is found with a couple of bit searches. blocks are
+ * split on malloc() and coalesced with their physical neighbours on free(),
+ * so both take constant time no matter how fragmented the heap is.
+ */
+
+#define TLSF_ALIGN_LOG2		2
+#define TLSF_ALIGN		(sizeof(size_t) > 4 ? 8 : 4)
+#define TLSF_SL_LOG2		4
+#define TLSF_SL_COUNT		(1 << TLSF_SL_LOG2)
+#define TLSF_FL_SHIFT		(TLSF_SL_LOG2 + TLSF_ALIGN_LOG2)
+#define TLSF_FL_MAX		25			/* blocks smaller than 32MB */
+#define TLSF_FL_COUNT		(TLSF_FL_MAX - TLSF_FL_SHIFT + 1)
+#define TLSF_SMALL_BLOCK	(1 << TLSF_FL_SHIFT)
+
+#define TLSF_FREE		1			/* block size flag */
+#define TLSF_HDR_SIZE		(2 * sizeof(size_t))	/* prev_phys and size */
+#define TLSF_MIN_SIZE		(2 * sizeof(size_t))	/* room for the free list links */
+
+struct tlsf_block_s {
+	struct tlsf_block_s *prev_phys;		/* previous block in memory */
+	size_t size;				/* payload size. the LSB is set if the block is free */
+	struct tlsf_block_s *next_free;		/* free list links (free blocks only) */
+	struct tlsf_block_s *prev_free;
+};
+
+static struct {
+	uint32_t fl_map;
+	uint32_t sl_map[TLSF_FL_COUNT];
+	struct tlsf_block_s *blocks[TLSF_FL_COUNT][TLSF_SL_COUNT];
+} tlsf;
+
+/* index of the least / most significant bit set (x != 0) */
+static int32_t tlsf_ffs(uint32_t x)
+{
+	int32_t n = 0;
+
+	if (!(x & 0x0000ffff)) {
+		n += 16;
+		x >>= 16;
+	}
+	if (!(x & 0x000000ff)) {
+		n += 8;
+		x >>= 8;
+	}
+	if (!(x & 0x0000000f)) {
+		n += 4;
+		x >>= 4;
+	}
+	if (!(x & 0x00000003)) {
+		n += 2;
+		x >>= 2;
+	}
+	if (!(x & 0x00000001))
+		n += 1;
+
+	return n;
+}
+
+static int32_t tlsf_fls(uint32_t x)
+{
+	int32_t n = 31;
+
+	if (!(x & 0xffff0000)) {
+		n -= 16;
+		x <<= 16;
+	}
+	if (!(x & 0xff000000)) {
+		n -= 8;
+		x <<= 8;
+	}
+	if (!(x & 0xf0000000)) {
+		n -= 4;
+		x <<= 4;
+	}
+	if (!(x & 0xc0000000)) {
+		n -= 2;
+		x <<= 2;
+	}
+	if (!(x & 0x80000000))
+		n -= 1;
+
+	return n;
+}
+
+static void tlsf_mapping(size_t size, int32_t *fl, int32_t *sl)
+{
+	int32_t f;
+
+	if (size < TLSF_SMALL_BLOCK) {
+		*fl = 0;
+		*sl = size >> TLSF_ALIGN_LOG2;
+	} else {
+		f = tlsf_fls(size);
+		*sl = (size >> (f - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+		*fl = f - TLSF_FL_SHIFT + 1;
+	}
+}
+
+static struct tlsf_block_s *tlsf_next(struct tlsf_block_s *block)
+{
+	return (struct tlsf_block_s *)((size_t)block + TLSF_HDR_SIZE + (block->size & ~TLSF_FREE));
+}
+
+static void tlsf_insert(struct tlsf_block_s *block)
+{
+	struct tlsf_block_s *head;
+	int32_t fl, sl;
+
+	tlsf_mapping(block->size & ~TLSF_FREE, &fl, &sl);
+	head = tlsf.blocks[fl][sl];
+	block->next_free = head;
+	block->prev_free = 0;
+	if (head)
+		head->prev_free = block;
+	tlsf.blocks[fl][sl] = block;
+	tlsf.fl_map |= (uint32_t)1 << fl;
+	tlsf.sl_map[fl] |= (uint32_t)1 << sl;
+	block->size |= TLSF_FREE;
+}
+
+static void tlsf_remove(struct tlsf_block_s *block)
+{
+	int32_t fl, sl;
+
+	tlsf_mapping(block->size & ~TLSF_FREE, &fl, &sl);
+	if (block->next_free)
+		block->next_free->prev_free = block->prev_free;
+	if (block->prev_free) {
+		block->prev_free->next_free = block->next_free;
+	} else {
+		tlsf.blocks[fl][sl] = block->next_free;
+		if (!block->next_free) {
+			tlsf.sl_map[fl] &= ~((uint32_t)1 << sl);
+			if (!tlsf.sl_map[fl])
+				tlsf.fl_map &= ~((uint32_t)1 << fl);
+		}
+	}
+	block->size &= ~TLSF_FREE;
+}
+
+/* first block on a list of blocks at least as large as size */
+static struct tlsf_block_s *tlsf_search(size_t size)
+{
+	uint32_t map;
+	int32_t fl, sl;
+
+	if (size >= TLSF_SMALL_BLOCK)
+		size += ((size_t)1 << (tlsf_fls(size) - TLSF_SL_LOG2)) - 1;
+	tlsf_mapping(size, &fl, &sl);
+	if (fl >= TLSF_FL_COUNT)
+		return 0;
+
+	map = tlsf.sl_map[fl] & ((uint32_t)~0 << sl);
+	if (!map) {
+		map = tlsf.fl_map & ((uint32_t)~0 << (fl + 1));
+		if (!map)
+			return 0;
+		fl = tlsf_ffs(map);
+		map = tlsf.sl_map[fl];
+	}
+	sl = tlsf_ffs(map);
+
+	return tlsf.blocks[fl][sl];
+}
+
+void ucx_free(void *ptr)
+{
+	struct tlsf_block_s *block, *p;
+
+	if (!ptr)
+		return;
+
+	CRITICAL_ENTER();
+	krnl_trace(TRACE_FREE, ptr);
+	block = (struct tlsf_block_s *)((size_t)ptr - TLSF_HDR_SIZE);
+
+	p = block->prev_phys;
+	if (p && (p->size & TLSF_FREE)) {
+		tlsf_remove(p);
+		p->size += TLSF_HDR_SIZE + block->size;
+		block = p;
+		tlsf_next(block)->prev_phys = block;
+	}
+
+	p = tlsf_next(block);
+	if (p->size & TLSF_FREE) {
+		tlsf_remove(p);
+		block->size += TLSF_HDR_SIZE + p->size;
+		tlsf_next(block)->prev_phys = block;
+	}
+
+	tlsf_insert(block);
+	CRITICAL_LEAVE();
+}
+
+void *ucx_malloc(uint32_t size)
+{
+	struct tlsf_block_s *block, *r;
+	size_t rsize;
+
+	/* larger than any block (and rounding it up could wrap around) */
+	if (size >= ((uint32_t)1 << TLSF_FL_MAX) - TLSF_ALIGN)
+		return 0;
+
+	size = (size + TLSF_ALIGN - 1) & ~(TLSF_ALIGN - 1);
+	if (size < TLSF_MIN_SIZE)
+		size = TLSF_MIN_SIZE;
+
+	CRITICAL_ENTER();
+	krnl_trace(TRACE_MALLOC, size);
+	block = tlsf_search(size);
+	if (!block) {
+		CRITICAL_LEAVE();
+
+		return 0;
+	}
+	tlsf_remove(block);
+
+	rsize = block->size - size;
+	if (rsize >= TLSF_HDR_SIZE + TLSF_MIN_SIZE) {
+		block->size = size;
+		r = tlsf_next(block);
+		r->prev_phys = block;
+		r->size = rsize - TLSF_HDR_SIZE;
+		tlsf_next(r)->prev_phys = r;
+		tlsf_insert(r);
+	}
+	CRITICAL_LEAVE();
+
+	return (void *)((size_t)block + TLSF_HDR_SIZE);
+}
+
+void ucx_heap_init(size_t *zone, uint32_t len)
+{
+	struct tlsf_block_s *block, *sentinel;
+	size_t start, end;
+
+	start = ((size_t)zone + TLSF_ALIGN - 1) & ~(TLSF_ALIGN - 1);
+	end = ((size_t)zone + len) & ~(TLSF_ALIGN - 1);
+	memset(&tlsf, 0, sizeof(tlsf));
+
+	/* one large free block, followed by a used (zero sized) sentinel */
+	block = (struct tlsf_block_s *)start;
+	block->prev_phys = 0;
+	block->size = end - start - 2 * TLSF_HDR_SIZE;
+	if ((uint32_t)block->size >= ((uint32_t)1 << TLSF_FL_MAX))
+		block->size = ((uint32_t)1 << TLSF_FL_MAX) - TLSF_ALIGN;
+	sentinel = tlsf_next(block);
+	sentinel->prev_phys = block;
+	sentinel->size = 0;
+	tlsf_insert(block);
+}
+
 #else
 
 /*
- * memory allocator using first-fit
+ * memory allocator using first-fit (default)
  * 
  * simple linked list of used/free areas. malloc() is slower, because free areas
  * are searched from the beginning of the heap and are coalesced on demand. yet,
@@ -115,6 +377,7 @@ void ucx_free(void *ptr)
 	struct mem_block_s *p;
 	
 	CRITICAL_ENTER();
+	krnl_trace(TRACE_FREE, ptr);
 	p = ((struct mem_block_s *)ptr) - 1;
 	p->size &= ~1L;
 	last_free = first_free;
@@ -128,6 +391,7 @@ void *ucx_malloc(uint32_t size)
 	size = align4(size);
 	
 	CRITICAL_ENTER();
+	krnl_trace(TRACE_MALLOC, size);
 	p = last_free;
 	q = p;
 
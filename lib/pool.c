@@ -0,0 +1,154 @@
+/* file:          pool.c
+ * description:   fixed size object pools
+ * date:          10/2026
+ * author:        Sergio Johann Filho <sergio.johann@acad.pucrs.br>
+ */
+
+#include <ucx.h>
+
+/*
+ * objects are carved from chunks of 'count' objects, allocated from the heap.
+ * free objects are kept in a singly linked list threaded through the objects
+ * themselves, so allocation and release take constant time. when a pool runs
+ * out of objects another chunk is added to it, and chunks are given back to
+ * the heap only when the pool is destroyed. objects of the same size are kept
+ * together and released objects are reused, so the heap is not fragmented by
+ * small objects being allocated and freed over and over.
+ */
+
+static int32_t pool_grow(struct pool_s *pool)
+{
+	struct pool_chunk_s *chunk;
+	char *obj;
+	void *first = 0;
+	uint16_t i;
+
+	chunk = malloc(sizeof(struct pool_chunk_s) + pool->obj_size * pool->count);
+
+	if (!chunk)
+		return -1;
+
+	obj = (char *)(chunk + 1);
+	for (i = 0; i < pool->count; i++, obj += pool->obj_size) {
+		*(void **)obj = first;
+		first = obj;
+	}
+
+	CRITICAL_ENTER();
+	chunk->next = pool->chunks;
+	pool->chunks = chunk;
+	*(void **)((char *)(chunk + 1)) = pool->free;
+	pool->free = first;
+	CRITICAL_LEAVE();
+
+	return 0;
+}
+
+struct pool_s *ucx_pool_create(uint32_t obj_size, uint16_t count)
+{
+	struct pool_s *pool;
+
+	if (!count)
+		return 0;
+
+	pool = malloc(sizeof(struct pool_s));
+
+	if (!pool)
+		return 0;
+
+	/* objects must hold the free list link, and keep it aligned */
+	if (obj_size < sizeof(void *))
+		obj_size = sizeof(void *);
+	obj_size = (obj_size + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1);
+
+	pool->free = 0;
+	pool->chunks = 0;
+	pool->obj_size = obj_size;
+	pool->count = count;
+	pool->used = 0;
+
+	if (pool_grow(pool)) {
+		free(pool);
+
+		return 0;
+	}
+
+	return pool;
+}
+
+/*
+ * returns a pool that is created on first use. the pool is created outside
+ * the critical section (it takes memory from the heap) and published inside
+ * it, so if two tasks race to create it one pool is kept and the other one
+ * is destroyed.
+ */
+struct pool_s *ucx_pool_get(struct pool_s **pool, uint32_t obj_size, uint16_t count)
+{
+	struct pool_s *new;
+
+	if (__atomic_load_n(pool, __ATOMIC_ACQUIRE))
+		return *pool;
+
+	new = ucx_pool_create(obj_size, count);
+
+	if (!new)
+		return 0;
+
+	CRITICAL_ENTER();
+	if (!*pool) {
+		__atomic_store_n(pool, new, __ATOMIC_RELEASE);
+		new = 0;
+	}
+	CRITICAL_LEAVE();
+
+	if (new)
+		ucx_pool_destroy(new);
+
+	return *pool;
+}
+
+int32_t ucx_pool_destroy(struct pool_s *pool)
+{
+	struct pool_chunk_s *chunk;
+
+	if (pool->used)
+		return -1;
+
+	while ((chunk = pool->chunks)) {
+		pool->chunks = chunk->next;
+		free(chunk);
+	}
+	free(pool);
+
+	return 0;
+}
+
+void *ucx_pool_alloc(struct pool_s *pool)
+{
+	void *obj;
+
+	for (;;) {
+		CRITICAL_ENTER();
+		obj = pool->free;
+		if (obj) {
+			pool->free = *(void **)obj;
+			pool->used++;
+		}
+		CRITICAL_LEAVE();
+
+		if (obj || pool_grow(pool))
+			return obj;
+	}
+}
+
+void ucx_pool_free(struct pool_s *pool, void *obj)
+{
+	if (!obj)
+		return;
+
+	CRITICAL_ENTER();
+	*(void **)obj = pool->free;
+	pool->free = obj;
+	pool->used--;
+	CRITICAL_LEAVE();
+}
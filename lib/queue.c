@@ -6,6 +6,8 @@
 
 #include <ucx.h>
 
+static struct pool_s *queue_pool;
+
 static int32_t ispowerof2(uint32_t x)
 {
 	return x && !(x & (x - 1));
@@ -34,7 +36,8 @@ struct queue_s *queue_create(int32_t size)
 	if (!ispowerof2(size))
 		size = nextpowerof2(size);
 	
-	q = malloc(sizeof(struct queue_s));
+	q = ucx_pool_get(&queue_pool, sizeof(struct queue_s), QUEUE_POOL_SIZE) ?
+		ucx_pool_alloc(queue_pool) : 0;
 	
 	if (!q)
 		return 0;
@@ -44,7 +47,7 @@ struct queue_s *queue_create(int32_t size)
 	q->pdata = malloc(q->size * sizeof(void *));
 	
 	if (!q->pdata) {
-		free(q);
+		ucx_pool_free(queue_pool, q);
 		return 0;
 	}
 	q->head = q->tail = 0;
@@ -57,7 +60,7 @@ int32_t queue_destroy(struct queue_s *q)
 {
 	if (q->head == q->tail && !q->elem) {
 		free(q->pdata);
-		free(q);
+		ucx_pool_free(queue_pool, q);
 		
 		return 0;
 	}
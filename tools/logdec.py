@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+#
+# file:          logdec.py
+# description:   deferred log decoder (see kernel/log.c)
+# date:          10/2026
+# author:        Sergio Johann Filho <sergio.johann@acad.pucrs.br>
+#
+# usage: logdec.py [-e image.elf] [file]
+#
+# Reads the console output of a target (from a file or the standard input,
+# e.g. 'make debug | tools/logdec.py'), replaces the '#L' log records by
+# their text and passes other lines through. Format strings (and constant
+# string arguments) are read from the ELF image the target is running.
+
+import re
+import struct
+import sys
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+EM_AVR = 83
+LOG_NO_TASK = 0xffff
+LOG_COMMIT = 0x80000000
+
+
+class Elf:
+	def __init__(self, path):
+		with open(path, 'rb') as f:
+			self.data = f.read()
+		if self.data[:4] != b'\x7fELF':
+			raise ValueError('%s: not an ELF file' % path)
+		bits64 = self.data[4] == 2
+		self.endian = '<' if self.data[5] == 1 else '>'
+		if bits64:
+			hdr = struct.unpack_from(self.endian + 'HHIQQQIHHHHHH', self.data, 16)
+		else:
+			hdr = struct.unpack_from(self.endian + 'HHIIIIIHHHHHH', self.data, 16)
+		self.machine = hdr[1]
+		shoff, shentsize, shnum = hdr[5], hdr[10], hdr[11]
+		self.sections = []
+		for i in range(shnum):
+			off = shoff + i * shentsize
+			if bits64:
+				sh = struct.unpack_from(self.endian + 'IIQQQQ', self.data, off)
+			else:
+				sh = struct.unpack_from(self.endian + 'IIIIII', self.data, off)
+			stype, flags, addr, offset, size = sh[1], sh[2], sh[3], sh[4], sh[5]
+			if flags & SHF_ALLOC and stype != SHT_NOBITS and size:
+				self.sections.append((addr, offset, size))
+
+	def string(self, addr):
+		addrs = [addr]
+		# AVR data space addresses are at 0x800000 in the ELF image
+		if self.machine == EM_AVR:
+			addrs.append(addr | 0x800000)
+		for a in addrs:
+			for base, offset, size in self.sections:
+				if base <= a < base + size:
+					start = offset + a - base
+					end = self.data.find(b'\0', start, offset + size)
+					if end < 0:
+						return None
+					return self.data[start:end].decode('latin-1')
+		return None
+
+
+SPEC = re.compile(r'%([-+ #0]*)(\d*)(?:\.(\d+))?(?:hh|h|ll|l|z)?([diouxXcsp%])')
+
+
+def format_record(elf, fmt, args):
+	args = list(args)
+
+	def conv(m):
+		flags, width, prec, conv = m.groups()
+		if conv == '%':
+			return '%'
+		val = args.pop(0) if args else 0
+		spec = '%' + flags + width + ('.' + prec if prec else '')
+		if conv in 'di':
+			if val & 0x80000000:
+				val -= 0x100000000
+			return (spec + 'd') % val
+		if conv == 'c':
+			return (spec + 'c') % chr(val & 0xff)
+		if conv == 's':
+			s = elf.string(val)
+			return (spec + 's') % (s if s is not None else '(0x%08x)' % val)
+		if conv == 'p':
+			return (spec + 's') % ('0x%08x' % val)
+		return (spec + conv) % val
+
+	return SPEC.sub(conv, fmt)
+
+
+def decode(elf, line):
+	words = [int(w, 16) for w in line[2:].split()]
+	if line.startswith('#D'):
+		return '[%d log records dropped]' % words[0]
+	# commit | task id << 8 | n, ticks, format address (1 or 2 words), args
+	if len(words) < 3 or not words[0] & LOG_COMMIT:
+		return line
+	n = words[0] & 0xff
+	addr_words = len(words) - 2 - n
+	if addr_words not in (1, 2):
+		return line
+	addr = words[2] | (words[3] << 32 if addr_words == 2 else 0)
+	fmt = elf.string(addr)
+	if fmt is None:
+		return '[bad log record: %s]' % line[2:].strip()
+	task = (words[0] >> 8) & 0xffff
+	text = format_record(elf, fmt, words[2 + addr_words:])
+	who = '-' if task == LOG_NO_TASK else str(task)
+	return '[%d] %s: %s' % (words[1], who, text.rstrip('\n'))
+
+
+def main():
+	argv = sys.argv[1:]
+	elf_path = 'build/target/image.elf'
+	if len(argv) >= 2 and argv[0] == '-e':
+		elf_path = argv[1]
+		argv = argv[2:]
+	elf = Elf(elf_path)
+	src = open(argv[0], 'r', errors='replace') if argv else sys.stdin
+
+	for line in src:
+		line = line.rstrip('\r\n')
+		if line.startswith('#L') or line.startswith('#D'):
+			try:
+				line = decode(elf, line)
+			except ValueError:
+				pass
+		print(line, flush=True)
+
+
+if __name__ == '__main__':
+	main()
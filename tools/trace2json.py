@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+#
+# file:          trace2json.py
+# description:   kernel event trace converter (see kernel/trace.c)
+# date:          10/2026
+# author:        Sergio Johann Filho <sergio.johann@acad.pucrs.br>
+#
+# usage: trace2json.py [file] > trace.json
+#
+# Reads the console output of a target (from a file or the standard input,
+# e.g. 'make debug | tools/trace2json.py'), takes the '#T' trace records and
+# writes them in the Trace Event Format (JSON), which can be opened in the
+# Perfetto UI (ui.perfetto.dev) or in chrome://tracing. Each task is shown
+# as a thread, running while it is switched in, and interrupt handlers are
+# shown in a separate track. Other lines are ignored.
+
+import json
+import sys
+
+SWITCH_IN, SWITCH_OUT, SEM_WAIT, SEM_SIGNAL, PIPE_BLOCK, PIPE_UNBLOCK, \
+	MALLOC, FREE, ISR_ENTER, ISR_EXIT = range(1, 11)
+
+NO_TASK = 0xffff
+IRQ_TRACK = 0x10000
+STATES = ['stopped', 'ready', 'running', 'blocked', 'suspended']
+INSTANT = {
+	SEM_WAIT: ('sem wait', 'sem'),
+	SEM_SIGNAL: ('sem signal', 'sem'),
+	PIPE_BLOCK: ('pipe block', 'pipe'),
+	PIPE_UNBLOCK: ('pipe unblock', 'pipe'),
+	MALLOC: ('malloc', 'size'),
+	FREE: ('free', 'ptr'),
+}
+
+
+class Converter:
+	def __init__(self):
+		self.events = []
+		self.tasks = set()
+		self.running = None		# task switched in
+		self.irqs = []			# interrupt handlers entered
+		self.last = None		# last raw timestamp
+		self.base = 0			# 32 bit timestamp wrap around
+
+	def stamp(self, t):
+		if self.last is not None and t < self.last:
+			self.base += 1 << 32
+		self.last = t
+		return self.base + t
+
+	def emit(self, ph, name, tid, ts, **kw):
+		ev = {'ph': ph, 'name': name, 'pid': 0, 'tid': tid, 'ts': ts}
+		ev.update(kw)
+		self.events.append(ev)
+
+	def record(self, t, info, arg):
+		ts = self.stamp(t)
+		event, task = info >> 16, info & 0xffff
+		if task != NO_TASK:
+			self.tasks.add(task)
+
+		if event == SWITCH_IN:
+			self.running = task
+			self.emit('B', 'task %d' % task, task, ts, args={'priority': arg})
+		elif event == SWITCH_OUT:
+			if self.running == task:
+				state = STATES[arg] if arg < len(STATES) else arg
+				self.emit('E', 'task %d' % task, task, ts, args={'state': state})
+			self.running = None
+		elif event == ISR_ENTER:
+			self.irqs.append(arg)
+			name = 'tick' if arg == 0 else 'irq %d' % arg
+			self.emit('B', name, IRQ_TRACK, ts)
+		elif event == ISR_EXIT:
+			if arg in self.irqs:
+				self.irqs.remove(arg)
+				self.emit('E', 'tick' if arg == 0 else 'irq %d' % arg, IRQ_TRACK, ts)
+		elif event in INSTANT:
+			name, key = INSTANT[event]
+			self.emit('i', name, task if task != NO_TASK else IRQ_TRACK, ts,
+				s='t', args={key: '0x%08x' % arg if key != 'size' else arg})
+
+	def finish(self):
+		# close the slices still open at the end of the trace
+		ts = self.base + (self.last or 0)
+		if self.running is not None:
+			self.emit('E', 'task %d' % self.running, self.running, ts)
+		for irq in self.irqs:
+			self.emit('E', 'tick' if irq == 0 else 'irq %d' % irq, IRQ_TRACK, ts)
+		meta = [{'ph': 'M', 'name': 'thread_name', 'pid': 0, 'tid': t,
+			'args': {'name': 'task %d' % t}} for t in sorted(self.tasks)]
+		meta.append({'ph': 'M', 'name': 'thread_name', 'pid': 0, 'tid': IRQ_TRACK,
+			'args': {'name': 'interrupts'}})
+		meta.append({'ph': 'M', 'name': 'process_name', 'pid': 0,
+			'args': {'name': 'UCX/OS'}})
+		return {'traceEvents': meta + self.events, 'displayTimeUnit': 'ns'}
+
+
+def main():
+	src = open(sys.argv[1], 'r', errors='replace') if len(sys.argv) > 1 else sys.stdin
+	conv = Converter()
+
+	for line in src:
+		if not line.startswith('#T'):
+			continue
+		try:
+			t, info, arg = [int(w, 16) for w in line[2:].split()]
+		except ValueError:
+			continue
+		conv.record(t, info, arg)
+
+	json.dump(conv.finish(), sys.stdout, indent=1)
+	print()
+
+
+if __name__ == '__main__':
+	main()